@@ -40,7 +40,8 @@ CasmReader::CasmReader()
       TraceRead(false),
       TraceTree(false),
       TraceLexer(false),
-      ErrorsFound(false) {}
+      ErrorsFound(false),
+      NativeDecode(nullptr) {}
 
 CasmReader::~CasmReader() {}
 
@@ -91,10 +92,21 @@ void CasmReader::readBinary(std::shared_ptr<Queue> Binary,
 void CasmReader::inflateBinary(std::shared_ptr<Queue> Binary,
                                std::shared_ptr<SymbolTable> AlgSymtab,
                                std::shared_ptr<InflateAst> Inflator) {
+  Inflator->setInstallDuringInflation(Install);
+  if (NativeDecode != nullptr && AlgSymtab == NativeSymtab && !TraceRead &&
+      !TraceTree) {
+    ByteReader Input(Binary);
+    if (!NativeDecode(Input, *Inflator)) {
+      foundErrors();
+      return;
+    }
+    Symtab = Inflator->getSymtab();
+    SymbolTable::registerAlgorithm(Symtab);
+    return;
+  }
   InterpreterFlags Flags;
   Interpreter MyReader(std::make_shared<ByteReader>(Binary), Inflator, Flags,
                        AlgSymtab);
-  Inflator->setInstallDuringInflation(Install);
   if (TraceRead || TraceTree) {
     auto Trace = std::make_shared<TraceClass>("CasmInterpreter");
     Trace->setTraceProgress(true);
@@ -31,6 +31,11 @@ class SymbolTable;
 class InflateAst;
 }  // end of namespace filt
 
+namespace interp {
+class Reader;
+class Writer;
+}  // end of namespace interp
+
 namespace decode {
 
 class Queue;
@@ -40,6 +45,9 @@ class CasmReader {
   CasmReader& operator=(const CasmReader&) = delete;
 
  public:
+  // A generated (native) decoder of an algorithm (see cast2casm --decoder).
+  typedef bool (*NativeDecoder)(interp::Reader& Input, interp::Writer& Output);
+
   CasmReader();
   ~CasmReader();
 
@@ -106,6 +114,14 @@ class CasmReader {
     TraceLexer = Value;
     return *this;
   }
+  // Reads binary files of algorithm AlgSymtab using Decoder, rather than
+  // interpreting AlgSymtab. Not used when tracing.
+  CasmReader& setNativeDecoder(std::shared_ptr<filt::SymbolTable> AlgSymtab,
+                               NativeDecoder Decoder) {
+    NativeSymtab = AlgSymtab;
+    NativeDecode = Decoder;
+    return *this;
+  }
   std::shared_ptr<filt::SymbolTable> getReadSymtab() { return Symtab; }
 
  private:
@@ -115,6 +131,8 @@ class CasmReader {
   bool TraceLexer;
   bool ErrorsFound;
   std::shared_ptr<filt::SymbolTable> Symtab;
+  std::shared_ptr<filt::SymbolTable> NativeSymtab;
+  NativeDecoder NativeDecode;
   void foundErrors();
   void inflateBinary(std::shared_ptr<Queue> Binary,
                      std::shared_ptr<filt::SymbolTable> AlgSymtab,
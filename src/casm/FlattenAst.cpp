@@ -61,9 +61,10 @@ void FlattenAst::write(IntType Value) {
   Writer->write(Value);
 }
 
-void FlattenAst::writeBit(uint8_t Bit) {
-  TRACE(uint8_t, "writeBBit", Bit);
-  Writer->writeBit(Bit);
+void FlattenAst::writeBits(uint32_t Value, unsigned NumBits) {
+  TRACE(uint32_t, "writeBits", Value);
+  TRACE(unsigned_int, "NumBits", NumBits);
+  Writer->writeBits(Value, NumBits);
 }
 
 void FlattenAst::writeHeaderValue(decode::IntType Value,
@@ -146,10 +147,20 @@ bool FlattenAst::binaryEvalEncode(const BinaryEval* Nd) {
   write(IntType(NodeType::BinaryEvalBits));
   TRACE(size_t, "NumBIts", PostorderEncoding.size());
   write(PostorderEncoding.size());
+  constexpr unsigned BitsInWord = sizeof(uint32_t) * CHAR_BIT;
+  uint32_t Bits = 0;
+  unsigned NumBits = 0;
   for (uint8_t Val : PostorderEncoding) {
     TRACE(uint8_t, "bit", Val);
-    writeBit(Val);
+    Bits = (Bits << 1) | Val;
+    if (++NumBits == BitsInWord) {
+      writeBits(Bits, NumBits);
+      Bits = 0;
+      NumBits = 0;
+    }
   }
+  if (NumBits)
+    writeBits(Bits, NumBits);
   return true;
 }
 
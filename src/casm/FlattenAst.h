@@ -76,7 +76,7 @@ class FlattenAst {
   void freezeOutput();
   bool binaryEvalEncode(const BinaryEval* Eval);
   void write(decode::IntType Value);
-  void writeBit(uint8_t Bit);
+  void writeBits(uint32_t Value, unsigned NumBits);
   void writeHeaderValue(decode::IntType Value, interp::IntTypeFormat Format);
   void writeAction(decode::IntType Action);
 };
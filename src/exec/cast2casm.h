@@ -21,6 +21,8 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdio>
+#include <limits>
+#include <set>
 
 #include "sexp-parser/Driver.h"
 #include "sexp/Ast.h"
@@ -74,10 +76,20 @@ class CodeGenerator {
         Namespaces(Namespaces),
         AlgName(AlgName),
         ErrorsFound(false),
-        NextIndex(1) {}
+        NextIndex(1),
+        DecoderDefine(nullptr),
+        DecoderIndent(0),
+        NextDecoderTemp(1) {}
   ~CodeGenerator() {}
   void generateDeclFile();
   void generateImplFile(bool UseArrayImpl);
+#if WASM_CAST_BOOT > 1
+  // Generates a (native) decoder for the algorithm, i.e. C++ code that
+  // decodes directly from a reader to a writer, without using an
+  // interpreter.
+  void generateDecoderDeclFile();
+  void generateDecoderImplFile();
+#endif
   bool foundErrors() const { return ErrorsFound; }
   void setStartPos(std::shared_ptr<ReadCursor> StartPos) { ReadPos = StartPos; }
 
@@ -134,6 +146,38 @@ class CodeGenerator {
     puts(AlgName);
     puts("Array");
   }
+  // Defines a decoder method (member function) to generate.
+  typedef std::pair<const Define*, uint32_t> DecoderMethod;
+  std::vector<DecoderMethod> DecoderMethods;
+  std::set<DecoderMethod> DecoderMethodSet;
+  // The define being generated, and the state of the generated code.
+  const Define* DecoderDefine;
+  // The (inlined) calls to defines with expression parameters, and the
+  // define each call appears in.
+  std::vector<std::pair<const Node*, const Define*>> DecoderInlinedCalls;
+  size_t DecoderIndent;
+  size_t NextDecoderTemp;
+#if WASM_CAST_BOOT > 1
+  void generateDecoderName();
+  void generateDecoderMethodName(const Define* Defn, uint32_t Mode);
+  void generateDecoderHeaderValues(const Node* Hdr, bool HasReadMode);
+  void generateDecoderMethod(const Define* Defn, uint32_t Mode);
+  void addDecoderMethod(const Define* Defn, uint32_t Mode);
+  void putDecoderIndent();
+  void putDecoderStmt(const std::string& Stmt);
+  void openDecoderBlock(const std::string& Head);
+  void closeDecoderBlock();
+  std::string generateDecoderTemp(const std::string& Expr);
+  std::string generateDecoderExpr(const Node* Nd, uint32_t Mode);
+  std::string generateDecoderEval(const Node* Nd, uint32_t Mode);
+  std::string generateDecoderInlinedEval(const Node* Nd,
+                                         const Define* Defn,
+                                         uint32_t Mode);
+  std::string generateDecoderParam(const Node* Nd, uint32_t Mode);
+  std::string generateDecoderSwitch(const Switch* Sel, uint32_t Mode);
+  std::string generateDecoderFail(const std::string& Message);
+  std::string generateDecoderBad(const Node* Nd);
+#endif
 };
 
 void CodeGenerator::generateInt(IntType Value) {
@@ -839,6 +883,666 @@ void CodeGenerator::generateImplFile(bool UseArrayImpl) {
   generateExitNamespaces();
 }
 
+#if WASM_CAST_BOOT > 1
+
+namespace {
+
+// Mode flags of generated decoder methods. Note: Matches the flags of
+// interpreter method modifiers.
+constexpr uint32_t DecoderReadFlag = 0x1;
+constexpr uint32_t DecoderWriteFlag = 0x2;
+constexpr uint32_t DecoderReadWriteFlags = DecoderReadFlag | DecoderWriteFlag;
+
+const std::string LastReadName("LastReadValue");
+
+std::string getDecoderInt(IntType Value) {
+  BufferType Buffer;
+  sprintf(Buffer, "%" PRIuMAX "%s", uintmax_t(Value),
+          Value > IntType(std::numeric_limits<int64_t>::max()) ? "ull" : "");
+  return Buffer;
+}
+
+std::string getDecoderVar(charstring Prefix, size_t Index) {
+  BufferType Buffer;
+  sprintf(Buffer, "%s%" PRIuMAX "", Prefix, uintmax_t(Index));
+  return Buffer;
+}
+
+// Returns the suffix of the reader/writer methods that read/write Format, or
+// nullptr if Format isn't an integer format.
+charstring getDecoderFormatName(NodeType Format) {
+  switch (Format) {
+    case NodeType::Bit:
+      return "Bit";
+    case NodeType::Uint8:
+      return "Uint8";
+    case NodeType::Uint32:
+      return "Uint32";
+    case NodeType::Uint64:
+      return "Uint64";
+    case NodeType::Varint32:
+      return "Varint32";
+    case NodeType::Varint64:
+      return "Varint64";
+    case NodeType::Varuint32:
+      return "Varuint32";
+    case NodeType::Varuint64:
+      return "Varuint64";
+    default:
+      return nullptr;
+  }
+}
+
+charstring getDecoderIntTypeFormatName(interp::IntTypeFormat Format) {
+  switch (Format) {
+    case interp::IntTypeFormat::Uint8:
+      return "interp::IntTypeFormat::Uint8";
+    case interp::IntTypeFormat::Varint32:
+      return "interp::IntTypeFormat::Varint32";
+    case interp::IntTypeFormat::Varuint32:
+      return "interp::IntTypeFormat::Varuint32";
+    case interp::IntTypeFormat::Uint32:
+      return "interp::IntTypeFormat::Uint32";
+    case interp::IntTypeFormat::Varint64:
+      return "interp::IntTypeFormat::Varint64";
+    case interp::IntTypeFormat::Varuint64:
+      return "interp::IntTypeFormat::Varuint64";
+    case interp::IntTypeFormat::Uint64:
+      return "interp::IntTypeFormat::Uint64";
+  }
+  WASM_RETURN_UNREACHABLE(nullptr);
+}
+
+}  // end of anonymous namespace
+
+void CodeGenerator::generateDecoderName() {
+  puts(AlgName);
+  puts("Decoder");
+}
+
+void CodeGenerator::generateDecoderMethodName(const Define* Defn,
+                                              uint32_t Mode) {
+  switch (Mode) {
+    case DecoderReadFlag:
+      puts("read");
+      break;
+    case DecoderWriteFlag:
+      puts("write");
+      break;
+    default:
+      puts("decode");
+      break;
+  }
+  std::string Name = Defn->getName();
+  putSymbol(Name.c_str());
+}
+
+void CodeGenerator::putDecoderIndent() {
+  for (size_t i = 0; i < DecoderIndent; ++i)
+    puts("  ");
+}
+
+void CodeGenerator::putDecoderStmt(const std::string& Stmt) {
+  putDecoderIndent();
+  puts(Stmt.c_str());
+  putc('\n');
+}
+
+void CodeGenerator::openDecoderBlock(const std::string& Head) {
+  putDecoderIndent();
+  puts(Head.c_str());
+  puts(" {\n");
+  ++DecoderIndent;
+}
+
+void CodeGenerator::closeDecoderBlock() {
+  --DecoderIndent;
+  putDecoderStmt("}");
+}
+
+std::string CodeGenerator::generateDecoderTemp(const std::string& Expr) {
+  std::string Name = getDecoderVar("V", NextDecoderTemp++);
+  putDecoderStmt("IntType " + Name + " = " + Expr + ";");
+  return Name;
+}
+
+std::string CodeGenerator::generateDecoderFail(const std::string& Message) {
+  putDecoderStmt("return fail(\"" + Message + "\");");
+  return "0";
+}
+
+std::string CodeGenerator::generateDecoderBad(const Node* Nd) {
+  fprintf(stderr, "Can't generate decoder for: ");
+  if (Nd == nullptr) {
+    fprintf(stderr, "nullptr\n");
+  } else {
+    TextWriter Writer;
+    Writer.writeAbbrev(stderr, Nd);
+  }
+  ErrorsFound = true;
+  return "0";
+}
+
+void CodeGenerator::addDecoderMethod(const Define* Defn, uint32_t Mode) {
+  DecoderMethod Method(Defn, Mode);
+  if (DecoderMethodSet.insert(Method).second)
+    DecoderMethods.push_back(Method);
+}
+
+void CodeGenerator::generateDecoderMethod(const Define* Defn, uint32_t Mode) {
+  TRACE_METHOD("generateDecoderMethod");
+  DecoderDefine = Defn;
+  NextDecoderTemp = 1;
+  DecoderIndent = 1;
+  putDecoderIndent();
+  puts("bool ");
+  generateDecoderMethodName(Defn, Mode);
+  putc('(');
+  for (size_t i = 0; i < Defn->getNumArgs(); ++i) {
+    if (i > 0)
+      puts(", ");
+    puts("IntType ");
+    puts(getDecoderVar("Param_", i).c_str());
+  }
+  puts(") {\n");
+  ++DecoderIndent;
+  if (size_t NumLocals = Defn->getNumLocals())
+    putDecoderStmt("IntType Locals[" + getDecoderVar("", NumLocals) +
+                   "] = {};");
+  generateDecoderExpr(Defn->getBody(), Mode);
+  putDecoderStmt("return true;");
+  closeDecoderBlock();
+  putc('\n');
+  DecoderDefine = nullptr;
+}
+
+std::string CodeGenerator::generateDecoderEval(const Node* Nd, uint32_t Mode) {
+  const Symbol* Sym = cast<Eval>(Nd)->getCallName();
+  const Define* Defn = Symtab->getSymbolDefn(Sym)->getDefineDefinition();
+  if (Defn == nullptr || Defn->getNumArgs() != size_t(Nd->getNumKids() - 1))
+    return generateDecoderBad(Nd);
+  if (Defn->getNumExprArgs() > 0)
+    return generateDecoderInlinedEval(Nd, Defn, Mode);
+  for (size_t i = 0; i < Defn->getNumArgs(); ++i)
+    if (Defn->getDefineFrame()->getArgType(i) != NodeType::ParamValues)
+      return generateDecoderBad(Nd);
+  std::vector<std::string> Args;
+  for (int i = 1; i < Nd->getNumKids(); ++i)
+    Args.push_back(
+        generateDecoderTemp(generateDecoderExpr(Nd->getKid(i), Mode)));
+  addDecoderMethod(Defn, Mode);
+  putDecoderIndent();
+  puts("if (!");
+  generateDecoderMethodName(Defn, Mode);
+  putc('(');
+  for (size_t i = 0; i < Args.size(); ++i) {
+    if (i > 0)
+      puts(", ");
+    puts(Args[i].c_str());
+  }
+  puts("))\n");
+  ++DecoderIndent;
+  putDecoderStmt("return false;");
+  --DecoderIndent;
+  return LastReadName;
+}
+
+// Note: Expression parameters are evaluated in the calling context. Hence,
+// calls to defines with expression parameters are inlined.
+std::string CodeGenerator::generateDecoderInlinedEval(const Node* Nd,
+                                                      const Define* Defn,
+                                                      uint32_t Mode) {
+  if (Defn->getNumValueArgs() > 0 || Defn->getNumLocals() > 0)
+    return generateDecoderBad(Nd);
+  for (const auto& Call : DecoderInlinedCalls)
+    if (Call.second == Defn)
+      // Recursive, can't inline.
+      return generateDecoderBad(Nd);
+  DecoderInlinedCalls.push_back(std::make_pair(Nd, DecoderDefine));
+  DecoderDefine = Defn;
+  generateDecoderExpr(Defn->getBody(), Mode);
+  DecoderDefine = DecoderInlinedCalls.back().second;
+  DecoderInlinedCalls.pop_back();
+  return LastReadName;
+}
+
+std::string CodeGenerator::generateDecoderParam(const Node* Nd,
+                                                uint32_t Mode) {
+  IntType Index = cast<Param>(Nd)->getValue();
+  if (!DecoderDefine->isValidArgIndex(Index))
+    return generateDecoderBad(Nd);
+  switch (DecoderDefine->getDefineFrame()->getArgType(Index)) {
+    case NodeType::ParamValues:
+      return getDecoderVar("Param_", Index);
+    case NodeType::ParamExprs: {
+      if (DecoderInlinedCalls.empty())
+        return generateDecoderBad(Nd);
+      // Evaluate the argument in the context of the (inlined) call.
+      std::pair<const Node*, const Define*> Call = DecoderInlinedCalls.back();
+      DecoderInlinedCalls.pop_back();
+      const Define* Defn = DecoderDefine;
+      DecoderDefine = Call.second;
+      std::string Value =
+          generateDecoderExpr(Call.first->getKid(Index + 1), Mode);
+      DecoderDefine = Defn;
+      DecoderInlinedCalls.push_back(Call);
+      return Value;
+    }
+    default:
+      return generateDecoderBad(Nd);
+  }
+}
+
+std::string CodeGenerator::generateDecoderSwitch(const Switch* Sel,
+                                                 uint32_t Mode) {
+  std::string Selector = generateDecoderExpr(Sel->getKid(0), Mode);
+  openDecoderBlock("switch (" + Selector + ")");
+  for (int i = 2; i < Sel->getNumKids(); ++i) {
+    const auto* C = dyn_cast<Case>(Sel->getKid(i));
+    if (C == nullptr)
+      continue;
+    // Note: Nested cases share the same case body. Only cases installed
+    // in the switch are reachable.
+    std::vector<std::string> Labels;
+    for (const Node* Nd = C; isa<Case>(Nd); Nd = Nd->getKid(1)) {
+      const auto* Key = cast<Case>(Nd);
+      if (Sel->getCase(Key->getValue()) == Key)
+        Labels.push_back("case " + getDecoderInt(Key->getValue()) + ":");
+    }
+    if (Labels.empty())
+      continue;
+    for (size_t j = 0; j + 1 < Labels.size(); ++j)
+      putDecoderStmt(Labels[j]);
+    openDecoderBlock(Labels.back());
+    std::string Value = generateDecoderExpr(C->getCaseBody(), Mode);
+    if (Value != LastReadName)
+      putDecoderStmt(LastReadName + " = " + Value + ";");
+    putDecoderStmt("break;");
+    closeDecoderBlock();
+  }
+  openDecoderBlock("default:");
+  generateDecoderExpr(Sel->getKid(1), Mode);
+  putDecoderStmt("break;");
+  closeDecoderBlock();
+  closeDecoderBlock();
+  return "0";
+}
+
+// Generates the statements that evaluate Nd, and returns a C++ expression
+// (without side effects) for the value of Nd. Note: The returned expression
+// must be used before generating any other statements.
+std::string CodeGenerator::generateDecoderExpr(const Node* Nd, uint32_t Mode) {
+  TRACE_METHOD("generateDecoderExpr");
+  TRACE(node_ptr, "Nd", Nd);
+  if (Nd == nullptr)
+    return generateDecoderBad(Nd);
+  const bool HasReadMode = Mode & DecoderReadFlag;
+  const bool HasWriteMode = Mode & DecoderWriteFlag;
+  switch (Nd->getType()) {
+    default:
+      return generateDecoderBad(Nd);
+    case NodeType::Sequence:
+      for (int i = 0; i < Nd->getNumKids(); ++i)
+        generateDecoderExpr(Nd->getKid(i), Mode);
+      return LastReadName;
+    case NodeType::Loop: {
+      std::string Count = generateDecoderExpr(Nd->getKid(0), Mode);
+      std::string Counter = getDecoderVar("V", NextDecoderTemp++);
+      openDecoderBlock("for (IntType " + Counter + " = " + Count + "; " +
+                       Counter + " > 0; --" + Counter + ")");
+      generateDecoderExpr(Nd->getKid(1), Mode);
+      closeDecoderBlock();
+      return "0";
+    }
+    case NodeType::LoopUnbounded:
+      openDecoderBlock("while (!Input.atInputEob())");
+      generateDecoderExpr(Nd->getKid(0), Mode);
+      closeDecoderBlock();
+      return "0";
+    case NodeType::IfThen:
+      openDecoderBlock("if (" + generateDecoderExpr(Nd->getKid(0), Mode) +
+                       ")");
+      generateDecoderExpr(Nd->getKid(1), Mode);
+      closeDecoderBlock();
+      return "0";
+    case NodeType::IfThenElse:
+      openDecoderBlock("if (" + generateDecoderExpr(Nd->getKid(0), Mode) +
+                       ")");
+      generateDecoderExpr(Nd->getKid(1), Mode);
+      closeDecoderBlock();
+      openDecoderBlock("else");
+      generateDecoderExpr(Nd->getKid(2), Mode);
+      closeDecoderBlock();
+      return "0";
+    case NodeType::Switch:
+      return generateDecoderSwitch(cast<Switch>(Nd), Mode);
+    case NodeType::Case: {
+      std::string Value =
+          generateDecoderExpr(cast<Case>(Nd)->getCaseBody(), Mode);
+      if (Value != LastReadName)
+        putDecoderStmt(LastReadName + " = " + Value + ";");
+      return LastReadName;
+    }
+    case NodeType::And:
+    case NodeType::Or: {
+      if (!HasReadMode)
+        return generateDecoderFail("Can't evaluate in write-only mode");
+      std::string Value =
+          generateDecoderTemp(generateDecoderExpr(Nd->getKid(0), Mode));
+      openDecoderBlock("if (" + Value +
+                       (Nd->getType() == NodeType::And ? " != 0)" : " == 0)"));
+      putDecoderStmt(Value + " = " + generateDecoderExpr(Nd->getKid(1), Mode) +
+                     ";");
+      closeDecoderBlock();
+      return Value;
+    }
+    case NodeType::Not:
+      if (!HasReadMode)
+        return generateDecoderFail("Can't evaluate in write-only mode");
+      return generateDecoderExpr(Nd->getKid(0), Mode);
+    case NodeType::BitwiseAnd:
+    case NodeType::BitwiseOr:
+    case NodeType::BitwiseXor: {
+      if (!HasReadMode)
+        return generateDecoderFail("Can't evaluate in write-only mode");
+      std::string Arg1 =
+          generateDecoderTemp(generateDecoderExpr(Nd->getKid(0), Mode));
+      std::string Arg2 = generateDecoderExpr(Nd->getKid(1), Mode);
+      charstring Op = " ^ ";
+      if (Nd->getType() == NodeType::BitwiseAnd)
+        Op = " & ";
+      else if (Nd->getType() == NodeType::BitwiseOr)
+        Op = " | ";
+      return "(" + Arg1 + Op + Arg2 + ")";
+    }
+    case NodeType::BitwiseNegate:
+      if (!HasReadMode)
+        return generateDecoderFail("Can't evaluate in write-only mode");
+      return "(~" + generateDecoderExpr(Nd->getKid(0), Mode) + ")";
+    case NodeType::Read:
+      return generateDecoderExpr(Nd->getKid(0), DecoderReadFlag);
+    case NodeType::Write: {
+      std::string Value("0");
+      for (int i = 1; i < Nd->getNumKids(); ++i) {
+        generateDecoderExpr(Nd->getKid(i), DecoderReadFlag);
+        Value = generateDecoderExpr(Nd->getKid(0), DecoderWriteFlag);
+      }
+      return Value;
+    }
+    case NodeType::Peek: {
+      putDecoderStmt("if (!Input.pushPeekPos())");
+      ++DecoderIndent;
+      generateDecoderFail("Unable to peek input");
+      --DecoderIndent;
+      std::string Value = generateDecoderTemp(
+          generateDecoderExpr(Nd->getKid(0), DecoderReadFlag));
+      putDecoderStmt("if (!Input.popPeekPos())");
+      ++DecoderIndent;
+      generateDecoderFail("Unable to peek input");
+      --DecoderIndent;
+      return Value;
+    }
+    case NodeType::Bit:
+    case NodeType::Uint32:
+    case NodeType::Uint64:
+    case NodeType::Uint8:
+    case NodeType::Varint32:
+    case NodeType::Varint64:
+    case NodeType::Varuint32:
+    case NodeType::Varuint64: {
+      std::string Format(getDecoderFormatName(Nd->getType()));
+      if (HasReadMode)
+        putDecoderStmt(LastReadName + " = Input.read" + Format + "();");
+      if (HasWriteMode)
+        putDecoderStmt("Output.write" + Format + "(" + LastReadName + ");");
+      return LastReadName;
+    }
+    case NodeType::I32Const:
+    case NodeType::I64Const:
+    case NodeType::One:
+    case NodeType::U8Const:
+    case NodeType::U32Const:
+    case NodeType::U64Const:
+    case NodeType::Zero: {
+      std::string Value = getDecoderInt(cast<IntegerNode>(Nd)->getValue());
+      if (!HasReadMode)
+        return Value;
+      putDecoderStmt(LastReadName + " = " + Value + ";");
+      return LastReadName;
+    }
+    case NodeType::LastRead:
+    case NodeType::Void:
+      return LastReadName;
+    case NodeType::Local: {
+      IntType Index = cast<Local>(Nd)->getValue();
+      if (!DecoderDefine->isValidLocalIndex(Index))
+        return generateDecoderBad(Nd);
+      return "Locals[" + getDecoderInt(Index) + "]";
+    }
+    case NodeType::Set: {
+      const auto* L = dyn_cast<Local>(Nd->getKid(0));
+      if (L == nullptr || !DecoderDefine->isValidLocalIndex(L->getValue()))
+        return generateDecoderBad(Nd);
+      putDecoderStmt("Locals[" + getDecoderInt(L->getValue()) + "] = " +
+                     generateDecoderExpr(Nd->getKid(1), Mode) + ";");
+      return LastReadName;
+    }
+    case NodeType::Param:
+      return generateDecoderParam(Nd, Mode);
+    case NodeType::EvalVirtual:
+      return generateDecoderEval(Nd, Mode);
+    case NodeType::Callback: {
+      std::string Action =
+          getDecoderInt(cast<Callback>(Nd)->getIntNode()->getValue());
+      putDecoderStmt("if (!Input.readAction(" + Action +
+                     ") || !Output.writeAction(" + Action + "))");
+      ++DecoderIndent;
+      generateDecoderFail("Unable to apply action");
+      --DecoderIndent;
+      return LastReadName;
+    }
+    case NodeType::Block:
+      putDecoderStmt(
+          "if (!Input.readAction(IntType(PredefinedSymbol::Block_enter)) ||");
+      putDecoderStmt(
+          "    !Output.writeAction(IntType(PredefinedSymbol::Block_enter)))");
+      ++DecoderIndent;
+      generateDecoderFail("Unable to enter block");
+      --DecoderIndent;
+      generateDecoderExpr(Nd->getKid(0), Mode);
+      putDecoderStmt(
+          "if (!Input.readAction(IntType(PredefinedSymbol::Block_exit)) ||");
+      putDecoderStmt(
+          "    !Output.writeAction(IntType(PredefinedSymbol::Block_exit)))");
+      ++DecoderIndent;
+      generateDecoderFail("Unable to close block");
+      --DecoderIndent;
+      return "0";
+    case NodeType::Error:
+      return generateDecoderFail("Algorithm error!");
+    case NodeType::LastSymbolIs:
+      // Note: Not implemented by the interpreter either.
+      return generateDecoderFail("Method not implemented!");
+  }
+  WASM_RETURN_UNREACHABLE("0");
+}
+
+void CodeGenerator::generateDecoderHeaderValues(const Node* Hdr,
+                                                bool HasReadMode) {
+  if (Hdr == nullptr) {
+    generateDecoderBad(Hdr);
+    return;
+  }
+  for (int i = 0; i < Hdr->getNumKids(); ++i) {
+    const auto* Lit = dyn_cast<IntegerNode>(Hdr->getKid(i));
+    if (Lit == nullptr || !Lit->definesIntTypeFormat()) {
+      generateDecoderBad(Hdr);
+      return;
+    }
+    std::string Format(getDecoderIntTypeFormatName(Lit->getIntTypeFormat()));
+    std::string Value = getDecoderInt(Lit->getValue());
+    if (HasReadMode) {
+      putDecoderStmt("if (!readHeaderValue(Input, " + Format + ", " + Value +
+                     "))");
+      ++DecoderIndent;
+      putDecoderStmt("return false;");
+      --DecoderIndent;
+    } else {
+      putDecoderStmt("Output.writeHeaderValue(" + Value + ", " + Format +
+                     ");");
+    }
+  }
+}
+
+void CodeGenerator::generateDecoderDeclFile() {
+  TRACE_METHOD("generateDecoderDeclFile");
+  generateHeader();
+  puts(
+      "#include \"interp/Reader.h\"\n"
+      "#include \"interp/Writer.h\"\n"
+      "\n");
+  generateEnterNamespaces();
+  puts(
+      "// Returns true if Input starts with the (read) header of the "
+      "algorithm.\n"
+      "// Does not consume any input.\n"
+      "bool has");
+  puts(AlgName);
+  puts(
+      "Header(interp::Reader& Input);\n"
+      "\n"
+      "// Decodes Input (including its header), writing the result to "
+      "Output.\n"
+      "// Returns true if successful.\n"
+      "bool decode");
+  puts(AlgName);
+  puts(
+      "(interp::Reader& Input, interp::Writer& Output);\n"
+      "\n");
+  generateExitNamespaces();
+}
+
+void CodeGenerator::generateDecoderImplFile() {
+  TRACE_METHOD("generateDecoderImplFile");
+  generateHeader();
+  puts(
+      "#include \"interp/Reader.h\"\n"
+      "#include \"interp/Writer.h\"\n"
+      "\n"
+      "#include <cstdio>\n"
+      "\n");
+  generateEnterNamespaces();
+  puts(
+      "using namespace wasm::filt;\n"
+      "\n"
+      "namespace {\n"
+      "\n"
+      "bool readHeaderValue(interp::Reader& Input,\n"
+      "                     interp::IntTypeFormat Format,\n"
+      "                     IntType WantedValue) {\n"
+      "  IntType FoundValue;\n"
+      "  return Input.readHeaderValue(Format, FoundValue) &&\n"
+      "         FoundValue == WantedValue;\n"
+      "}\n"
+      "\n"
+      "bool readHeader(interp::Reader& Input) {\n");
+  DecoderIndent = 1;
+  generateDecoderHeaderValues(Symtab->getReadHeader(), true);
+  puts(
+      "  return true;\n"
+      "}\n"
+      "\n"
+      "class ");
+  generateDecoderName();
+  puts(
+      " {\n"
+      " public:\n"
+      "  ");
+  generateDecoderName();
+  puts(
+      "(interp::Reader& Input, interp::Writer& Output)\n"
+      "      : Input(Input),\n"
+      "        Output(Output),\n"
+      "        LastReadValue(0),\n"
+      "        ErrorMessage(nullptr) {}\n"
+      "\n"
+      "  charstring getErrorMessage() const { return ErrorMessage; }\n"
+      "\n"
+      "  bool decompress() {\n"
+      "    if (!readHeader(Input))\n"
+      "      return fail(\"Unable to read header\");\n");
+  DecoderIndent = 2;
+  generateDecoderHeaderValues(Symtab->getWriteHeader(), false);
+  puts(
+      "    if (!Output.writeHeaderClose())\n"
+      "      return fail(\"Unable to write header\");\n");
+  Symbol* File = Symtab->getPredefined(PredefinedSymbol::File);
+  const Define* FileDefn = File ? File->getDefineDefinition() : nullptr;
+  if (FileDefn == nullptr) {
+    fprintf(stderr, "Can't find sexpression to process file\n");
+    ErrorsFound = true;
+  } else {
+    addDecoderMethod(FileDefn, DecoderReadWriteFlags);
+    puts("    if (!");
+    generateDecoderMethodName(FileDefn, DecoderReadWriteFlags);
+    puts(
+        "())\n"
+        "      return false;\n");
+  }
+  puts(
+      "    if (!Output.writeFreezeEof())\n"
+      "      return fail(\"Unable to freeze eof\");\n"
+      "    if (!Input.processedInputCorrectly(true))\n"
+      "      return fail(\"Malformed input\");\n"
+      "    return true;\n"
+      "  }\n"
+      "\n"
+      " private:\n"
+      "  interp::Reader& Input;\n"
+      "  interp::Writer& Output;\n"
+      "  IntType LastReadValue;\n"
+      "  charstring ErrorMessage;\n"
+      "\n"
+      "  bool fail(charstring Message) {\n"
+      "    ErrorMessage = Message;\n"
+      "    return false;\n"
+      "  }\n"
+      "\n");
+  // Note: Generating a method may add methods to generate.
+  for (size_t i = 0; i < DecoderMethods.size(); ++i)
+    generateDecoderMethod(DecoderMethods[i].first, DecoderMethods[i].second);
+  puts(
+      "};\n"
+      "\n"
+      "}  // end of anonymous namespace\n"
+      "\n"
+      "bool has");
+  puts(AlgName);
+  puts(
+      "Header(interp::Reader& Input) {\n"
+      "  if (!Input.pushPeekPos())\n"
+      "    return false;\n"
+      "  bool Matches = readHeader(Input);\n"
+      "  return Input.popPeekPos() && Matches;\n"
+      "}\n"
+      "\n"
+      "bool decode");
+  puts(AlgName);
+  puts("(interp::Reader& Input, interp::Writer& Output) {\n  ");
+  generateDecoderName();
+  puts(
+      " Decoder(Input, Output);\n"
+      "  if (Decoder.decompress())\n"
+      "    return true;\n"
+      "  fprintf(stderr, \"Error: %s\\n\", Decoder.getErrorMessage());\n"
+      "  return false;\n"
+      "}\n"
+      "\n");
+  generateExitNamespaces();
+}
+
+#endif
+
 std::shared_ptr<SymbolTable> readCasmFile(
     const char* Filename,
     bool Verbose,
@@ -918,6 +1622,7 @@ int main(int Argc, charstring Argv[]) {
 
 #if WASM_CAST_BOOT > 1
   bool BitCompress = true;
+  bool GenerateDecoder = false;
   bool MinimizeBlockSize = false;
   bool TraceFlatten = false;
   bool TraceWrite = false;
@@ -1070,6 +1775,13 @@ int main(int Argc, charstring Argv[]) {
                      "ALGORITHM(s). If repeated, each file defines the "
                      "enclosing scope for the next ALGORITHM file"));
 
+    ArgsParser::Optional<bool> GenerateDecoderFlag(GenerateDecoder);
+    Args.add(GenerateDecoderFlag.setLongName("decoder")
+                 .setDescription(
+                     "Generate C++ source code implementing a decoder for the "
+                     "algorithm, that reads and writes directly (i.e. without "
+                     "an interpreter)"));
+
     ArgsParser::Optional<bool> BitCompressFlag(BitCompress);
     Args.add(BitCompressFlag.setLongName("bit-compress")
                  .setDescription(
@@ -1144,6 +1856,18 @@ int main(int Argc, charstring Argv[]) {
       fprintf(stderr, "Opition --array can't be used with option --header\n");
       return exit_status(EXIT_FAILURE);
     }
+
+    if (GenerateDecoder && AlgName == nullptr) {
+      fprintf(stderr, "Option --decoder can't be used without option --name\n");
+      return exit_status(EXIT_FAILURE);
+    }
+
+    if (GenerateDecoder && (UseArrayImpl || GenerateEnum || GenerateFunction)) {
+      fprintf(stderr,
+              "Option --decoder can't be used with options --array, --enum, "
+              "or --function\n");
+      return exit_status(EXIT_FAILURE);
+    }
 #endif
   }
 
@@ -1300,6 +2024,19 @@ int main(int Argc, charstring Argv[]) {
   Namespaces.push_back("decode");
   CodeGenerator Generator(InputFilename, Output, InputSymtab, Namespaces,
                           AlgName);
+#if WASM_CAST_BOOT > 1
+  if (GenerateDecoder) {
+    if (HeaderFile)
+      Generator.generateDecoderDeclFile();
+    else
+      Generator.generateDecoderImplFile();
+    if (Generator.foundErrors()) {
+      fprintf(stderr, "Unable to generate valid C++ decoder!\n");
+      return exit_status(EXIT_FAILURE);
+    }
+    return exit_status(EXIT_SUCCESS);
+  }
+#endif
   if (HeaderFile)
     Generator.generateDeclFile();
   else {
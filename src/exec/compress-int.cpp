@@ -19,6 +19,7 @@
 #include "intcomp/IntCompress.h"
 #include "stream/FileReader.h"
 #include "stream/FileWriter.h"
+#include "stream/MappedFileQueue.h"
 #include "stream/ReadBackedQueue.h"
 #include "stream/WriteBackedQueue.h"
 #include "utils/ArgsParse.h"
@@ -29,15 +30,28 @@ using namespace wasm;
 using namespace wasm::decode;
 using namespace wasm::filt;
 using namespace wasm::intcomp;
+using namespace wasm::interp;
 using namespace wasm::utils;
 
 charstring InputFilename = "-";
 charstring OutputFilename = "-";
+charstring IndexFilename = nullptr;
 
 std::shared_ptr<RawStream> getInput() {
   return std::make_shared<FileReader>(InputFilename);
 }
 
+// Maps the input file into memory when possible, avoiding copying the input
+// into queue pages.
+std::shared_ptr<Queue> getInputQueue() {
+  if (strcmp(InputFilename, "-") != 0) {
+    auto Mapped = std::make_shared<MappedFileQueue>(InputFilename);
+    if (!Mapped->hasErrors())
+      return Mapped;
+  }
+  return std::make_shared<ReadBackedQueue>(getInput());
+}
+
 std::shared_ptr<RawStream> getOutput() {
   return std::make_shared<FileWriter>(OutputFilename);
 }
@@ -194,6 +208,23 @@ int main(int Argc, const char* Argv[]) {
             .setDescription("Mimimum number of uses of a small value before "
                             "it is considered an abbreviation pattern"));
 
+    ArgsParser::Optional<charstring> IndexFilenameFlag(IndexFilename);
+    Args.add(IndexFilenameFlag.setLongName("index")
+                 .setOptionName("FILE")
+                 .setDescription(
+                     "Also generate an index of the compressed file, allowing "
+                     "each section (and group of function bodies) to be "
+                     "decompressed separately"));
+
+    ArgsParser::Optional<size_t> IndexFunctionIntervalFlag(
+        MyCompressionFlags.IndexFunctionInterval);
+    Args.add(IndexFunctionIntervalFlag.setDefault(100)
+                 .setLongName("index-interval")
+                 .setOptionName("INTEGER")
+                 .setDescription(
+                     "Number of function bodies in each group of the index "
+                     "(0 implies only index sections)"));
+
     ArgsParser::Toggle TrimOverriddenPatternsFlag(
         MyCompressionFlags.TrimOverriddenPatterns);
     Args.add(TrimOverriddenPatternsFlag.setDefault(true)
@@ -388,6 +419,8 @@ int main(int Argc, const char* Argv[]) {
   if (MyCompressionFlags.MatchSingletonsLast)
     fprintf(stderr, "*** Running singleton patterns experiment...\n");
 
+  MyCompressionFlags.GenerateIndex = IndexFilename != nullptr;
+
   SymbolTable::SharedPtr AlgSymtab;
   if (AlgorithmFilenames.empty()) {
     if (MyCompressionFlags.TraceCompression)
@@ -408,7 +441,7 @@ int main(int Argc, const char* Argv[]) {
     AlgSymtab = Reader.getReadSymtab();
   }
 
-  IntCompressor Compressor(std::make_shared<ReadBackedQueue>(getInput()),
+  IntCompressor Compressor(getInputQueue(),
                            std::make_shared<WriteBackedQueue>(getOutput()),
                            AlgSymtab, MyCompressionFlags);
   Compressor.compress();
@@ -416,5 +449,22 @@ int main(int Argc, const char* Argv[]) {
     fatal("Failed to compress due to errors!");
     exit_status(EXIT_FAILURE);
   }
+  if (IndexFilename != nullptr) {
+    std::shared_ptr<DecompressIndex> Index = Compressor.getIndex();
+    if (!Index) {
+      fprintf(stderr, "Unable to generate index: %s\n", IndexFilename);
+      return exit_status(EXIT_FAILURE);
+    }
+    if (MyCompressionFlags.TraceCompression)
+      Index->describe(stderr);
+    std::vector<uint8_t> IndexBytes;
+    Index->write(IndexBytes);
+    FileWriter IndexOutput(IndexFilename);
+    if (!IndexOutput.write(IndexBytes.data(), IndexBytes.size()) ||
+        !IndexOutput.freeze()) {
+      fprintf(stderr, "Unable to write index: %s\n", IndexFilename);
+      return exit_status(EXIT_FAILURE);
+    }
+  }
   return exit_status(EXIT_SUCCESS);
 }
@@ -16,16 +16,20 @@
  */
 
 #include "algorithms/casm0x0.h"
+#include "algorithms/casm0x0-decoder.h"
 #include "algorithms/cism0x0.h"
 #include "algorithms/wasm0xd.h"
+#include "algorithms/wasm0xd-decoder.h"
 #include "casm/CasmReader.h"
 #include "interp/ByteReader.h"
 #include "interp/ByteWriter.h"
 #include "interp/Decompress.h"
 #include "interp/DecompressSelector.h"
 #include "interp/Interpreter.h"
+#include "interp/SectionDecompressor.h"
 #include "stream/FileReader.h"
 #include "stream/FileWriter.h"
+#include "stream/MappedFileQueue.h"
 #include "stream/ReadBackedQueue.h"
 #include "stream/WriteBackedQueue.h"
 #include "utils/ArgsParse.h"
@@ -45,14 +49,49 @@ std::shared_ptr<RawStream> getInput() {
   return std::make_shared<FileReader>(InputFilename);
 }
 
+// Returns the queue to decompress from, or nullptr if unable to open the
+// input file. Maps the input file into memory when possible.
+// Returns the input queue. If the input file could be memory-mapped, Mapped
+// is also set to the (returned) queue.
+std::shared_ptr<Queue> getInputQueue(std::shared_ptr<MappedFileQueue>& Mapped) {
+  Mapped.reset();
+  if (strcmp(InputFilename, "-") != 0) {
+    auto MappedInput = std::make_shared<MappedFileQueue>(InputFilename);
+    if (!MappedInput->hasErrors()) {
+      Mapped = MappedInput;
+      return Mapped;
+    }
+  }
+  std::shared_ptr<RawStream> Input = getInput();
+  if (Input->hasErrors())
+    return nullptr;
+  return std::make_shared<ReadBackedQueue>(Input);
+}
+
 std::shared_ptr<RawStream> getOutput() {
   return std::make_shared<FileWriter>(OutputFilename);
 }
 
-int runUsingCApi(bool TraceProgress) {
+void listFunction(void*,
+                  int32_t Index,
+                  const uint8_t*,
+                  int32_t Begin,
+                  int32_t End) {
+  fprintf(stderr, "Function %" PRId32 ": [%" PRId32 ", %" PRId32 ")\n", Index,
+          Begin, End);
+}
+
+void* createDecompressor(bool TraceProgress, bool ListFunctions) {
   void* Decomp = create_decompressor();
   if (TraceProgress)
     set_trace_decompression(Decomp, TraceProgress);
+  if (ListFunctions)
+    set_decompressor_function_callback(Decomp, listFunction, nullptr);
+  return Decomp;
+}
+
+int runUsingCApi(bool TraceProgress, bool ListFunctions, int32_t Budget) {
+  void* Decomp = createDecompressor(TraceProgress, ListFunctions);
   auto Input = getInput();
   auto Output = getOutput();
   constexpr int32_t MaxBufferSize = 4096;
@@ -61,7 +100,15 @@ int runUsingCApi(bool TraceProgress) {
   // the decompression.
   int32_t BufferSize = 0;
   bool MoreInput = true;
-  while (BufferSize >= 0) {
+  bool InProgress = false;
+  while (true) {
+    if (BufferSize == DECOMPRESSOR_IN_PROGRESS) {
+      // Budget used up, collect available output before continuing.
+      InProgress = true;
+      BufferSize = get_decompressor_output_size(Decomp);
+    }
+    if (BufferSize < 0)
+      break;
     // Collect output if available.
     while (BufferSize > 0) {
       int32_t ChunkSize = std::min(BufferSize, MaxBufferSize);
@@ -75,6 +122,12 @@ int runUsingCApi(bool TraceProgress) {
     }
     if (BufferSize < 0)
       break;
+    if (InProgress) {
+      // Continue with the input already passed in.
+      InProgress = false;
+      BufferSize = resume_decompression_with_budget(Decomp, 0, Budget);
+      continue;
+    }
     // Fill the buffer with more input.
     while (MoreInput && BufferSize < MaxBufferSize) {
       size_t Count = Input->read(Buffer, MaxBufferSize - BufferSize);
@@ -85,12 +138,85 @@ int runUsingCApi(bool TraceProgress) {
       BufferSize += Count;
     }
     // Pass in new input and resume decompression.
-    BufferSize = resume_decompression(Decomp, BufferSize);
+    BufferSize = resume_decompression_with_budget(Decomp, BufferSize, Budget);
   }
   int Result = BufferSize == DECOMPRESSOR_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
   return Result;
 }
 
+int runUsingCApiInto(bool TraceProgress, bool ListFunctions) {
+  void* Decomp = createDecompressor(TraceProgress, ListFunctions);
+  auto Input = getInput();
+  auto Output = getOutput();
+  constexpr int32_t MaxBufferSize = 4096;
+  uint8_t InBuffer[MaxBufferSize];
+  uint8_t OutBuffer[MaxBufferSize];
+  int32_t InSize = 0;
+  int32_t InIndex = 0;
+  bool MoreInput = true;
+  int32_t Status = 0;
+  while (Status >= 0) {
+    if (InIndex == InSize && MoreInput) {
+      InSize = Input->read(InBuffer, MaxBufferSize);
+      InIndex = 0;
+      if (InSize == 0)
+        MoreInput = false;
+    }
+    int32_t Consumed = 0;
+    int32_t Produced = 0;
+    Status = decompress_into(Decomp, InBuffer + InIndex, InSize - InIndex,
+                             OutBuffer, MaxBufferSize, &Consumed, &Produced);
+    InIndex += Consumed;
+    if (Produced > 0 && !Output->write(OutBuffer, Produced))
+      Status = DECOMPRESSOR_ERROR;
+  }
+  return Status == DECOMPRESSOR_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Reads all of the bytes of File into Bytes. Returns false if unable to.
+bool readFile(charstring Filename, std::vector<uint8_t>& Bytes) {
+  FileReader Input(Filename);
+  if (Input.hasErrors())
+    return false;
+  constexpr size_t BufferSize = 4096;
+  uint8_t Buffer[BufferSize];
+  while (size_t Count = Input.read(Buffer, BufferSize))
+    Bytes.insert(Bytes.end(), Buffer, Buffer + Count);
+  return !Input.hasErrors();
+}
+
+int runUsingCApiIndex(bool TraceProgress,
+                      charstring IndexFilename,
+                      int32_t Entry) {
+  std::vector<uint8_t> Compressed;
+  std::vector<uint8_t> Index;
+  if (!readFile(InputFilename, Compressed) || !readFile(IndexFilename, Index))
+    return EXIT_FAILURE;
+  if (TraceProgress)
+    fprintf(stderr, "Index entries: %" PRId32 "\n",
+            get_decompressor_index_size(Index.data(), Index.size()));
+  void* Decomp = createDecompressor(TraceProgress, false);
+  auto Output = getOutput();
+  constexpr int32_t MaxBufferSize = 4096;
+  uint8_t* Buffer = get_decompressor_buffer(Decomp, MaxBufferSize);
+  int32_t BufferSize =
+      decompress_indexed_entry(Decomp, Compressed.data(), Compressed.size(),
+                               Index.data(), Index.size(), Entry);
+  while (BufferSize > 0) {
+    int32_t ChunkSize = std::min(BufferSize, MaxBufferSize);
+    if (!fetch_decompressor_output(Decomp, ChunkSize) ||
+        !Output->write(Buffer, ChunkSize)) {
+      BufferSize = DECOMPRESSOR_ERROR;
+      break;
+    }
+    BufferSize -= ChunkSize;
+    if (BufferSize == 0)
+      BufferSize = resume_decompression(Decomp, 0);
+  }
+  destroy_decompressor(Decomp);
+  return BufferSize == DECOMPRESSOR_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 std::vector<charstring> Algorithms;
 std::vector<size_t> AlgorithmsSeparators;
 size_t NextAlgorithm = 1;
@@ -113,8 +239,17 @@ void getNextSeparator() {
 int main(const int Argc, const char* Argv[]) {
   bool Verbose = false;
   bool MinimizeBlockSize = false;
+  bool PrecomputeBlockSizes = false;
   bool UseCApi = false;
+  bool UseCApiInto = false;
+  size_t CApiBudget = 0;
+  bool ListFunctions = false;
+  charstring IndexFilename = nullptr;
+  size_t IndexEntry = 0;
+  bool UseNativeDecoder = false;
   size_t NumTries = 1;
+  size_t NumJobs = 1;
+  bool PipelineStages = false;
   InterpreterFlags InterpFlags;
 
   {
@@ -124,6 +259,39 @@ int main(const int Argc, const char* Argv[]) {
     Args.add(UseCApiFlag.setLongName("c-api").setDescription(
         "Use C API to decompress"));
 
+    ArgsParser::Optional<bool> UseCApiIntoFlag(UseCApiInto);
+    Args.add(UseCApiIntoFlag.setLongName("c-api-into")
+                 .setDescription(
+                     "Use C API to decompress, passing input and output "
+                     "buffers to decompress_into()"));
+
+    ArgsParser::Optional<size_t> CApiBudgetFlag(CApiBudget);
+    Args.add(CApiBudgetFlag.setLongName("c-api-budget")
+                 .setOptionName("N")
+                 .setDescription(
+                     "When using the C API, run at most N interpreter steps "
+                     "per call (0 implies no limit)"));
+
+    ArgsParser::Optional<bool> ListFunctionsFlag(ListFunctions);
+    Args.add(ListFunctionsFlag.setLongName("list-functions")
+                 .setDescription(
+                     "When using the C API, print the output range of each "
+                     "function body (to stderr) as soon as it is "
+                     "decompressed"));
+
+    ArgsParser::Optional<charstring> IndexFilenameFlag(IndexFilename);
+    Args.add(IndexFilenameFlag.setLongName("index")
+                 .setOptionName("FILE")
+                 .setDescription(
+                     "Use C API to only decompress the entry (see "
+                     "--index-entry) of index FILE generated by compress-int"));
+
+    ArgsParser::Optional<size_t> IndexEntryFlag(IndexEntry);
+    Args.add(IndexEntryFlag.setLongName("index-entry")
+                 .setOptionName("N")
+                 .setDescription(
+                     "The entry of the index to decompress (see --index)"));
+
     ArgsParser::Optional<bool> ExpectExitFailFlag(ExpectExitFail);
     Args.add(
         ExpectExitFailFlag.setLongName("expect-fail")
@@ -167,12 +335,44 @@ int main(const int Argc, const char* Argv[]) {
             .setDescription("Toggle minimizing decompressed size (rather than "
                             "conanical size)"));
 
+    ArgsParser::Optional<bool> PrecomputeBlockSizesFlag(PrecomputeBlockSizes);
+    Args.add(PrecomputeBlockSizesFlag.setLongName("precompute-sizes")
+                 .setDescription(
+                     "Compute (minimized) block sizes before writing blocks, "
+                     "rather than moving blocks after their size is known"));
+
+    ArgsParser::Toggle BytecodeFlag(InterpFlags.UseBytecode);
+    Args.add(BytecodeFlag.setDefault(true)
+                 .setLongName("bytecode")
+                 .setDescription(
+                     "Toggle compiling algorithm definitions to bytecode "
+                     "(rather than walking the nodes of each definition)"));
+
+    ArgsParser::Optional<bool> UseNativeDecoderFlag(UseNativeDecoder);
+    Args.add(UseNativeDecoderFlag.setLongName("native").setDescription(
+        "Use the generated (native) decoders of built-in algorithms, rather "
+        "than interpreting them. Applies to the input when it uses wasm0xd, "
+        "and to (binary) algorithm files read using casm0x0"));
+
     ArgsParser::Optional<size_t> NumTriesFlag(NumTries);
     Args.add(
         NumTriesFlag.setLongName("tries").setOptionName("N").setDescription(
             "Decompress N times (used to test performance "
             "when N!=1)"));
 
+    ArgsParser::Optional<size_t> NumJobsFlag(NumJobs);
+    Args.add(NumJobsFlag.setLongName("jobs").setOptionName("N").setDescription(
+        "Decompress the sections (and code section function bodies) of a "
+        "WASM 0xd module using N threads. Only applies when no additional "
+        "algorithms are specified. Other inputs, including compressed "
+        "(casm/cism) files, are decompressed using a single thread"));
+
+    ArgsParser::Optional<bool> PipelineStagesFlag(PipelineStages);
+    Args.add(PipelineStagesFlag.setLongName("pipeline").setDescription(
+        "Run the final algorithm (that generates the WASM binary) on a "
+        "separate thread, concurrently with the algorithm that decompresses "
+        "the input"));
+
     ArgsParser::Toggle VerboseFlag(Verbose);
     Args.add(
         VerboseFlag.setShortName('v').setLongName("verbose").setDescription(
@@ -207,12 +407,19 @@ int main(const int Argc, const char* Argv[]) {
     }
   }
 
-  if (UseCApi) {
+  if (IndexFilename != nullptr)
+    return exit_status(
+        runUsingCApiIndex(Verbose >= 1, IndexFilename, int32_t(IndexEntry)));
+
+  if (UseCApi || UseCApiInto) {
     if (NumTries != 1) {
       fprintf(stderr, "-t and --c-api options not allowed");
       return exit_status(EXIT_FAILURE);
     }
-    return exit_status(runUsingCApi(Verbose >= 1));
+    if (UseCApiInto)
+      return exit_status(runUsingCApiInto(Verbose >= 1, ListFunctions));
+    return exit_status(
+        runUsingCApi(Verbose >= 1, ListFunctions, int32_t(CApiBudget)));
   }
 
   std::vector<std::shared_ptr<SymbolTable>> AdditionalAlgorithms;
@@ -224,6 +431,8 @@ int main(const int Argc, const char* Argv[]) {
       fprintf(stderr, "Opening algorithm file (%" PRIuMAX "): %s\n",
               uintmax_t(NextAlgorithm), Filename);
     CasmReader Reader;
+    if (UseNativeDecoder)
+      Reader.setNativeDecoder(getAlgcasm0x0Symtab(), decodeAlgcasm0x0);
     Reader.setInstall(true).readTextOrBinary(Filename, AlgSymtab);
     AlgSymtab = Reader.getReadSymtab();
     size_t NextIndex = AlgIndex + 1;
@@ -238,32 +447,27 @@ int main(const int Argc, const char* Argv[]) {
     }
   }
 
-  bool Succeeded = true;  // until proven otherwise.
-  for (size_t i = 0; i < NumTries; ++i) {
-    if (Verbose)
-      fprintf(stderr, "Opening input file: %s\n", InputFilename);
-    std::shared_ptr<RawStream> Input = getInput();
-    if (Input->hasErrors()) {
-      fprintf(stderr, "Problems opening %s!\n", InputFilename);
-      return exit_status(EXIT_SUCCESS);
-    }
-    if (Verbose)
-      fprintf(stderr, "Opening output file: %s\n", OutputFilename);
-    std::shared_ptr<RawStream> Output = getOutput();
-    if (Output->hasErrors()) {
-      fprintf(stderr, "Problems opening %s!\n", OutputFilename);
-      return exit_status(EXIT_SUCCESS);
+  // Decompresses Input to Output, returning true if successful.
+  auto Decompress = [&](std::shared_ptr<Queue> Input,
+                        std::shared_ptr<Queue> Output) -> bool {
+    auto Writer = std::make_shared<ByteWriter>(Output);
+    Writer->setMinimizeBlockSize(MinimizeBlockSize);
+    Writer->setPrecomputeBlockSizes(PrecomputeBlockSizes);
+    auto Reader = std::make_shared<ByteReader>(Input);
+    if (UseNativeDecoder && AdditionalAlgorithms.empty() &&
+        hasAlgwasm0xdHeader(*Reader)) {
+      if (Verbose)
+        fprintf(stderr, "Using native decoder\n");
+      return decodeAlgwasm0xd(*Reader, *Writer);
     }
-    if (Verbose)
-      fprintf(stderr, "Decompressing...\n");
-    // Create input, output, and decompressor.
-    std::shared_ptr<Queue> BackedOutput =
-        std::make_shared<WriteBackedQueue>(Output);
-    auto Writer = std::make_shared<ByteWriter>(BackedOutput);
-    Interpreter Decompressor(
-        std::make_shared<ByteReader>(std::make_shared<ReadBackedQueue>(Input)),
-        Writer, InterpFlags);
+    Interpreter Decompressor(Reader, Writer, InterpFlags);
     auto AlgState = std::make_shared<DecompAlgState>(&Decompressor);
+    // Note: Traces are not thread safe, and intermediate streams are not
+    // kept when pipelined.
+    AlgState->setPipelineStages(PipelineStages && !InterpFlags.TraceProgress &&
+                                !InterpFlags.TraceIntermediateStreams);
+    if (UseNativeDecoder)
+      AlgState->setNativeDecoder(getAlgwasm0xdSymtab(), decodeAlgwasm0xd);
     // Add additional algorithms first, so that they can override.
     for (std::shared_ptr<SymbolTable> Symtab : AdditionalAlgorithms) {
       Decompressor.addSelector(
@@ -277,17 +481,66 @@ int main(const int Argc, const char* Argv[]) {
     Decompressor.addSelector(
         std::make_shared<DecompressSelector>(getAlgcism0x0Symtab(), AlgState));
     // Decompress.
-    Writer->setMinimizeBlockSize(MinimizeBlockSize);
     if (InterpFlags.TraceProgress) {
       auto Trace = std::make_shared<TraceClass>("Decompress");
       Trace->setTraceProgress(true);
       Decompressor.setTrace(Trace);
     }
     Decompressor.algorithmRead();
-    if (Decompressor.errorsFound()) {
+    return !Decompressor.errorsFound();
+  };
+
+  bool Succeeded = true;  // until proven otherwise.
+  for (size_t i = 0; i < NumTries; ++i) {
+    if (Verbose)
+      fprintf(stderr, "Opening input file: %s\n", InputFilename);
+    std::shared_ptr<MappedFileQueue> MappedInput;
+    std::shared_ptr<Queue> Input = getInputQueue(MappedInput);
+    if (!Input) {
+      fprintf(stderr, "Problems opening %s!\n", InputFilename);
+      return exit_status(EXIT_SUCCESS);
+    }
+    if (Verbose)
+      fprintf(stderr, "Opening output file: %s\n", OutputFilename);
+    std::shared_ptr<RawStream> Output = getOutput();
+    if (Output->hasErrors()) {
+      fprintf(stderr, "Problems opening %s!\n", OutputFilename);
+      return exit_status(EXIT_SUCCESS);
+    }
+    if (Verbose)
+      fprintf(stderr, "Decompressing...\n");
+    if (NumJobs > 1 && AdditionalAlgorithms.empty()) {
+      SectionDecompressor Sections(Decompress, NumJobs);
+      bool Decompressed = MappedInput ? Sections.decompress(MappedInput, Output)
+                                      : Sections.decompress(Input, Output);
+      if (!Decompressed) {
+        fatal("Failed to decompress due to errors!");
+        Succeeded = false;
+      }
+      if (Verbose) {
+        fprintf(stderr, "Sections decompressed in parallel: %" PRIuMAX "\n",
+                uintmax_t(Sections.getNumSections()));
+        fprintf(stderr, "Function groups decompressed in parallel: %" PRIuMAX
+                "\n", uintmax_t(Sections.getNumFunctionGroups()));
+      }
+      continue;
+    }
+    std::shared_ptr<Queue> BackedOutput =
+        std::make_shared<WriteBackedQueue>(Output);
+    if (!Decompress(Input, BackedOutput)) {
       fatal("Failed to decompress due to errors!");
       Succeeded = false;
     }
+    if (Verbose) {
+      fprintf(stderr, "Input pages: %" PRIuMAX " allocated, %" PRIuMAX
+                      " reused\n",
+              uintmax_t(Input->getNumPagesAllocated()),
+              uintmax_t(Input->getNumPagesReused()));
+      fprintf(stderr, "Output pages: %" PRIuMAX " allocated, %" PRIuMAX
+                      " reused\n",
+              uintmax_t(BackedOutput->getNumPagesAllocated()),
+              uintmax_t(BackedOutput->getNumPagesReused()));
+    }
   }
   return exit_status(Succeeded ? EXIT_SUCCESS : EXIT_FAILURE);
 }
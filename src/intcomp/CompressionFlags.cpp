@@ -54,6 +54,8 @@ CompressionFlags::CompressionFlags()
       DefaultFormat(IntTypeFormat::Varint64),
       LoopSizeFormat(IntTypeFormat::Varuint64),
       MatchSingletonsLast(false),
+      GenerateIndex(false),
+      IndexFunctionInterval(0),
       TraceMatchSingletonsLast(false),
       TraceHuffmanAssignments(false),
       TraceReadingInput(false),
@@ -71,6 +71,11 @@ struct CompressionFlags {
   interp::IntTypeFormat DefaultFormat;
   interp::IntTypeFormat LoopSizeFormat;
   bool MatchSingletonsLast;
+  // If true, build the index of the compressed file (see
+  // interp/DecompressIndex.h), with an entry for each section, and each
+  // IndexFunctionInterval function bodies (if non-zero).
+  bool GenerateIndex;
+  size_t IndexFunctionInterval;
 
   interp::InterpreterFlags MyInterpFlags;
 
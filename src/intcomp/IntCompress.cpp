@@ -26,6 +26,7 @@
 #include "intcomp/RemoveNodesVisitor.h"
 #include "interp/ByteReader.h"
 #include "interp/ByteWriter.h"
+#include "interp/IndexWriter.h"
 #include "interp/IntInterpreter.h"
 #include "interp/IntReader.h"
 #include "interp/Interpreter.h"
@@ -103,9 +104,15 @@ void IntCompressor::writeDataOutput(const BitWriteCursor& StartPos,
   TRACE_METHOD("writeDataOutput");
   auto Writer = std::make_shared<ByteWriter>(Output);
   Writer->setPos(StartPos);
+  std::shared_ptr<interp::Writer> DataWriter = Writer;
+  if (MyFlags.GenerateIndex) {
+    Index = std::make_shared<DecompressIndex>();
+    DataWriter = std::make_shared<IndexWriter>(Writer, Index,
+                                               MyFlags.IndexFunctionInterval);
+  }
   InterpreterFlags InterpFlags = MyFlags.MyInterpFlags;
   InterpFlags.MacroContext = MacroDirective::Contract;
-  Interpreter MyReader(std::make_shared<IntReader>(IntOutput), Writer,
+  Interpreter MyReader(std::make_shared<IntReader>(IntOutput), DataWriter,
                        InterpFlags, Symtab);
   if (MyFlags.TraceWritingDataOutput)
     MyReader.getTrace().setTraceProgress(true);
@@ -22,6 +22,7 @@
 #include "intcomp/AbbrevAssignWriter.h"
 #include "intcomp/CompressionFlags.h"
 #include "intcomp/CountNode.h"
+#include "interp/DecompressIndex.h"
 #include "interp/IntFormats.h"
 #include "interp/IntStream.h"
 #include "interp/Interpreter.h"
@@ -55,6 +56,10 @@ class IntCompressor FINAL {
 
   void compress();
 
+  // Returns the index of the compressed file, if generated (see
+  // CompressionFlags::GenerateIndex).
+  std::shared_ptr<interp::DecompressIndex> getIndex() { return Index; }
+
   void setTraceProgress(bool NewValue) {
     // TODO: Don't force creation of trace object if not needed.
     getTrace().setTraceProgress(NewValue);
@@ -99,6 +104,7 @@ class IntCompressor FINAL {
   std::shared_ptr<filt::SymbolTable> Symtab;
   std::shared_ptr<interp::IntStream> Contents;
   std::shared_ptr<interp::IntStream> IntOutput;
+  std::shared_ptr<interp::DecompressIndex> Index;
   std::shared_ptr<utils::TraceClass> Trace;
   bool ErrorsFound;
   void readInput();
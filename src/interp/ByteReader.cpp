@@ -18,7 +18,10 @@
 
 #include "interp/ByteReader.h"
 
+#include <algorithm>
+
 #include "interp/ByteReadStream.h"
+#include "interp/FormattedValue-templates.h"
 #include "interp/ReadStream.h"
 #include "sexp/Ast.h"
 #include "utils/Casting.h"
@@ -101,6 +104,9 @@ namespace {
 // can be done in a single iteration of the loop.
 constexpr size_t kResumeHeadroom = 100;
 
+// The maximum number of bytes in a (LEB128 encoded) varuint32.
+constexpr size_t kMaxVaruint32Size = 5;
+
 }  // end of anonymous namespace
 
 bool ByteReader::canProcessMoreInputNow() {
@@ -117,6 +123,10 @@ bool ByteReader::stillMoreInputToProcessNow() {
   return ReadPos.getCurAddress() <= FillPos;
 }
 
+bool ByteReader::isAllInputAvailable() {
+  return ReadPos.isEofFrozen();
+}
+
 BitReadCursor& ByteReader::getPos() {
   return ReadPos;
 }
@@ -146,6 +156,10 @@ decode::StreamType ByteReader::getStreamType() {
   return Input->getType();
 }
 
+ReadCursor* ByteReader::getBytePos() {
+  return Input->getType() == StreamType::Byte ? &ReadPos : nullptr;
+}
+
 bool ByteReader::processedInputCorrectly(bool CheckForEof) {
   return (!CheckForEof || ReadPos.atEof()) && ReadPos.isQueueGood();
 }
@@ -172,6 +186,21 @@ bool ByteReader::readBinary(const Node* Eval, IntType& Value) {
   if (!isa<BinaryEval>(Eval))
     return false;
   const Node* Encoding = cast<BinaryEval>(Eval)->getKid(0);
+  // Decode using tables, as long as the bits can be peeked.
+  const BinaryEval::DecodeTable* Table =
+      cast<BinaryEval>(Eval)->getDecodeTable();
+  BitReadCursor::WordType Index;
+  while (ReadPos.peekBits(Table->NumBits, Index)) {
+    const BinaryEval::DecodeEntry& Entry = Table->Entries[Index];
+    ReadPos.readBits(Entry.NumBits);
+    if (Entry.Next == nullptr) {
+      Encoding = Entry.Nd;
+      break;
+    }
+    Table = Entry.Next;
+    Encoding = Table->Root;
+  }
+  // Read remaining bits (if any) one at a time.
   while (1) {
     switch (Encoding->getType()) {
       case NodeType::BinaryAccept:
@@ -234,6 +263,45 @@ uint64_t ByteReader::readVaruint64() {
   return Input->readVaruint64(ReadPos);
 }
 
+size_t ByteReader::getNumAvailableValues(size_t Count, size_t MaxValueSize) {
+  // Note: Each value must start at or before FillPos, so that it lies
+  // within the resume headroom.
+  if (ReadPos.isEofFrozen())
+    return Count;
+  size_t Address = ReadPos.getCurAddress();
+  if (Address >= FillPos)
+    return 1;
+  return std::min(Count, (FillPos - Address) / MaxValueSize + 1);
+}
+
+size_t ByteReader::readUint8Array(uint8_t* Values, size_t Count) {
+  Count = getNumAvailableValues(Count, sizeof(uint8_t));
+  size_t NumRead = 0;
+  while (NumRead < Count) {
+    size_t Size =
+        std::min(Count - NumRead, ReadPos.getContiguousBytesAvailable());
+    if (Size == 0) {
+      // At a page boundary, let the cursor advance to the next page.
+      Values[NumRead++] = Input->readUint8(ReadPos);
+      continue;
+    }
+    memcpy(Values + NumRead, ReadPos.getBufferPtr(), Size);
+    ReadPos.consumeContiguousBytes(Size);
+    NumRead += Size;
+  }
+  return Count;
+}
+
+size_t ByteReader::readVaruint32Array(uint32_t* Values, size_t Count) {
+  Count = getNumAvailableValues(Count, kMaxVaruint32Size);
+  Input->readVaruint32Array(ReadPos, Values, Count);
+  return Count;
+}
+
+bool ByteReader::readValue(const filt::Node* Format, IntType& Value) {
+  return readFormattedValue(*this, Format, Value);
+}
+
 bool ByteReader::tablePush(IntType Value) {
   if (TblHandler == nullptr)
     TblHandler = new TableHandler(*this);
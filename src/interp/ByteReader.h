@@ -30,7 +30,7 @@ namespace interp {
 
 class ReadStream;
 
-class ByteReader : public Reader {
+class ByteReader FINAL : public Reader {
   ByteReader() = delete;
   ByteReader(const ByteReader&) = delete;
   ByteReader& operator=(const ByteReader&) = delete;
@@ -44,6 +44,7 @@ class ByteReader : public Reader {
   void describePeekPosStack(FILE* Out) OVERRIDE;
   bool canProcessMoreInputNow() OVERRIDE;
   bool stillMoreInputToProcessNow() OVERRIDE;
+  bool isAllInputAvailable() OVERRIDE;
   bool atInputEof() OVERRIDE;
   bool atInputEob() OVERRIDE;
   bool pushPeekPos() OVERRIDE;
@@ -52,6 +53,7 @@ class ByteReader : public Reader {
   bool processedInputCorrectly(bool CheckForEof) OVERRIDE;
   void readFillStart() OVERRIDE;
   void readFillMoreInput() OVERRIDE;
+  decode::ReadCursor* getBytePos() OVERRIDE;
   uint8_t readBit() OVERRIDE;
   uint8_t readUint8() OVERRIDE;
   uint32_t readUint32() OVERRIDE;
@@ -60,6 +62,9 @@ class ByteReader : public Reader {
   int64_t readVarint64() OVERRIDE;
   uint32_t readVaruint32() OVERRIDE;
   uint64_t readVaruint64() OVERRIDE;
+  size_t readUint8Array(uint8_t* Values, size_t Count) OVERRIDE;
+  size_t readVaruint32Array(uint32_t* Values, size_t Count) OVERRIDE;
+  bool readValue(const filt::Node* Format, decode::IntType& Value) OVERRIDE;
   bool alignToByte() OVERRIDE;
   bool readBlockEnter() OVERRIDE;
   bool readBlockExit() OVERRIDE;
@@ -82,6 +87,7 @@ class ByteReader : public Reader {
   decode::BitReadCursor SavedPos;
   utils::ValueStack<decode::BitReadCursor> SavedPosStack;
   TableHandler* TblHandler;
+  size_t getNumAvailableValues(size_t Count, size_t MaxValueSize);
 };
 
 }  // end of namespace interp
@@ -17,6 +17,10 @@
 // Implements a byte stream writer.
 
 #include "interp/ByteWriteStream.h"
+
+#include <algorithm>
+
+#include "interp/FormatHelpers-templates.h"
 #include "stream/ReadCursor.h"
 #include "stream/WriteCursor.h"
 
@@ -47,6 +51,10 @@ void ByteWriteStream::writeVarintBlockSize(decode::WriteCursor& Pos,
   writeVaruint32(BlockSize, Pos);
 }
 
+size_t ByteWriteStream::getVarintBlockSizeWidth(size_t BlockSize) {
+  return fmt::getLEB128Size(uint32_t(BlockSize));
+}
+
 size_t ByteWriteStream::getBlockSize(decode::WriteCursor& StartPos,
                                      decode::WriteCursor& EndPos) {
   return EndPos.getCurAddress() - (StartPos.getCurAddress() + ChunksInWord);
@@ -55,9 +63,25 @@ size_t ByteWriteStream::getBlockSize(decode::WriteCursor& StartPos,
 void ByteWriteStream::moveBlock(decode::WriteCursor& Pos,
                                 size_t StartAddress,
                                 size_t Size) {
+  // Note: Blocks only move towards the beginning of the stream. Hence,
+  // copying contiguous spans (in order) with memmove is safe, even when the
+  // source and destination overlap.
   ReadCursor CopyPos(Pos, StartAddress);
-  for (size_t i = 0; i < Size; ++i)
-    Pos.writeByte(CopyPos.readByte());
+  while (Size > 0) {
+    size_t Count =
+        std::min(Size, std::min(CopyPos.getContiguousBytesAvailable(),
+                                Pos.getContiguousBytesAvailable()));
+    if (Count == 0) {
+      // At a page boundary, let the cursors advance to the next page.
+      Pos.writeByte(CopyPos.readByte());
+      --Size;
+      continue;
+    }
+    memmove(Pos.getBufferPtr(), CopyPos.getBufferPtr(), Count);
+    CopyPos.consumeContiguousBytes(Count);
+    Pos.consumeContiguousBytes(Count);
+    Size -= Count;
+  }
 }
 
 }  // end of namespace decode
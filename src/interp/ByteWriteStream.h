@@ -43,6 +43,7 @@ class ByteWriteStream FINAL : public WriteStream {
   void writeFixedBlockSize(decode::WriteCursor& Pos, size_t BlockSize) OVERRIDE;
   void writeVarintBlockSize(decode::WriteCursor& Pos,
                             size_t BlockSIze) OVERRIDE;
+  size_t getVarintBlockSizeWidth(size_t BlockSize) OVERRIDE;
   size_t getBlockSize(decode::WriteCursor& StartPos,
                       decode::WriteCursor& EndPos) OVERRIDE;
   void moveBlock(decode::WriteCursor& Pos,
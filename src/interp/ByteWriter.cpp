@@ -18,12 +18,15 @@
 
 #include "interp/ByteWriter.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 #include "interp/ByteWriteStream.h"
+#include "interp/FormattedValue-templates.h"
 #include "interp/WriteStream.h"
 #include "sexp/Ast.h"
 #include "stream/Queue.h"
+#include "stream/ReadCursor.h"
 #include "stream/WriteCursor.h"
 #include "utils/Casting.h"
 
@@ -35,6 +38,30 @@ using namespace utils;
 
 namespace interp {
 
+namespace {
+
+constexpr unsigned kBitsInWord = sizeof(BitWriteCursor::WordType) * CHAR_BIT;
+
+void copyBytes(ReadCursor& ReadPos, WriteCursor& WritePos, size_t Size) {
+  while (Size > 0) {
+    size_t Count =
+        std::min(Size, std::min(ReadPos.getContiguousBytesAvailable(),
+                                WritePos.getContiguousBytesAvailable()));
+    if (Count == 0) {
+      // At a page boundary, let the cursors advance to the next page.
+      WritePos.writeByte(ReadPos.readByte());
+      --Size;
+      continue;
+    }
+    memcpy(WritePos.getBufferPtr(), ReadPos.getBufferPtr(), Count);
+    ReadPos.consumeContiguousBytes(Count);
+    WritePos.consumeContiguousBytes(Count);
+    Size -= Count;
+  }
+}
+
+}  // end of anonymous namespace
+
 // This class is used to implement the Table operator interface. It uses a
 // scratchpad for writing. This is done to simplify the write API. The
 // cursors/methods do not need to know if they are working on the scratchpad
@@ -94,20 +121,130 @@ bool ByteWriter::TableHandler::tablePop() {
   return true;
 }
 
+// This class implements precomputed block sizes. Rather than backpatching
+// (and moving) each block on exit, the outermost block is written to a
+// scratch queue, without size fields, while recording where each (nested)
+// block starts. Block sizes are computed bottom-up as blocks exit. When the
+// outermost block exits, the scratch queue is copied to the output in a
+// single pass, inserting the size of each block as it is reached.
+class ByteWriter::BlockSizeHandler {
+  BlockSizeHandler() = delete;
+  BlockSizeHandler(const BlockSizeHandler&) = delete;
+  BlockSizeHandler& operator=(const BlockSizeHandler&) = delete;
+
+ public:
+  explicit BlockSizeHandler(ByteWriter& Writer);
+  ~BlockSizeHandler();
+  // Returns false if the block must be handled by the caller (i.e. the
+  // writer has been redirected away from the scratch queue).
+  bool blockEnter();
+  bool blockExit();
+
+ private:
+  struct BlockInfo {
+    AddressType StartAddress;
+    // Number of bytes in the block, once known.
+    size_t Size;
+    // Number of bytes used by size fields of nested blocks.
+    size_t NestedSizeBytes;
+    explicit BlockInfo(AddressType StartAddress)
+        : StartAddress(StartAddress), Size(0), NestedSizeBytes(0) {}
+  };
+  ByteWriter& Writer;
+  std::shared_ptr<Queue> Scratch;
+  // Pins the scratch pages until they are copied to the output.
+  std::unique_ptr<ReadCursor> ScratchStart;
+  BitWriteCursor OutputPos;
+  // Blocks in the order they were entered.
+  std::vector<BlockInfo> Blocks;
+  // Indices (into Blocks) of blocks not yet exited.
+  std::vector<size_t> OpenBlocks;
+
+  void writeBlocks();
+};
+
+ByteWriter::BlockSizeHandler::BlockSizeHandler(ByteWriter& Writer)
+    : Writer(Writer) {}
+
+ByteWriter::BlockSizeHandler::~BlockSizeHandler() {}
+
+bool ByteWriter::BlockSizeHandler::blockEnter() {
+  BitWriteCursor& WritePos = Writer.WritePos;
+  if (OpenBlocks.empty()) {
+    OutputPos = WritePos;
+    Scratch = std::make_shared<Queue>();
+    ScratchStart.reset(new ReadCursor(StreamType::Byte, Scratch));
+    WritePos = BitWriteCursor(StreamType::Byte, Scratch);
+    Blocks.clear();
+  } else if (WritePos.getQueue() != Scratch) {
+    return false;
+  }
+  OpenBlocks.push_back(Blocks.size());
+  Blocks.emplace_back(WritePos.getCurAddress());
+  return true;
+}
+
+bool ByteWriter::BlockSizeHandler::blockExit() {
+  BitWriteCursor& WritePos = Writer.WritePos;
+  if (OpenBlocks.empty() || WritePos.getQueue() != Scratch)
+    return false;
+  BlockInfo& Block = Blocks[OpenBlocks.back()];
+  OpenBlocks.pop_back();
+  Block.Size =
+      (WritePos.getCurAddress() - Block.StartAddress) + Block.NestedSizeBytes;
+  TRACE_USING(Writer.getTrace(), uint32_t, "New block size", Block.Size);
+  if (OpenBlocks.empty()) {
+    writeBlocks();
+    return true;
+  }
+  Blocks[OpenBlocks.back()].NestedSizeBytes +=
+      Block.NestedSizeBytes +
+      Writer.Stream->getVarintBlockSizeWidth(Block.Size);
+  return true;
+}
+
+void ByteWriter::BlockSizeHandler::writeBlocks() {
+  BitWriteCursor& WritePos = Writer.WritePos;
+  WritePos.freezeEof();
+  AddressType EndAddress = WritePos.getCurAddress();
+  WritePos = OutputPos;
+  {
+    // Note: ScratchStart keeps the first page in the queue, so a new cursor
+    // starts at the beginning of the scratch queue.
+    ReadCursor ReadPos(StreamType::Byte, Scratch);
+    for (const BlockInfo& Block : Blocks) {
+      copyBytes(ReadPos, WritePos,
+                Block.StartAddress - ReadPos.getCurAddress());
+      Writer.Stream->writeVarintBlockSize(WritePos, Block.Size);
+    }
+    copyBytes(ReadPos, WritePos, EndAddress - ReadPos.getCurAddress());
+  }
+  // Release the scratch pages.
+  ScratchStart.reset();
+  OutputPos = BitWriteCursor();
+  Scratch.reset();
+  Blocks.clear();
+}
+
 ByteWriter::ByteWriter(std::shared_ptr<decode::Queue> Output)
     : Writer(true),
       WritePos(StreamType::Byte, Output),
       Stream(std::make_shared<ByteWriteStream>()),
       BlockStartStack(BlockStart),
-      TblHandler(nullptr) {}
+      TblHandler(nullptr),
+      SizeHandler(nullptr),
+      PrecomputeBlockSizes(false) {}
 
 ByteWriter::~ByteWriter() {
   delete TblHandler;
+  delete SizeHandler;
 }
 
 void ByteWriter::reset() {
   BlockStart = BitWriteCursor();
   BlockStartStack.clear();
+  delete SizeHandler;
+  SizeHandler = nullptr;
 }
 
 void ByteWriter::setPos(const decode::BitWriteCursor& NewPos) {
@@ -130,11 +267,20 @@ decode::StreamType ByteWriter::getStreamType() const {
   return Stream->getType();
 }
 
+WriteCursor* ByteWriter::getBytePos() {
+  return Stream->getType() == StreamType::Byte ? &WritePos : nullptr;
+}
+
 bool ByteWriter::writeBit(uint8_t Value) {
   Stream->writeBit(Value, WritePos);
   return WritePos.isQueueGood();
 }
 
+bool ByteWriter::writeBits(uint32_t Value, unsigned Count) {
+  WritePos.writeBits(Value, Count);
+  return WritePos.isQueueGood();
+}
+
 bool ByteWriter::writeUint8(uint8_t Value) {
   Stream->writeUint8(Value, WritePos);
   return WritePos.isQueueGood();
@@ -170,6 +316,32 @@ bool ByteWriter::writeVaruint64(uint64_t Value) {
   return WritePos.isQueueGood();
 }
 
+bool ByteWriter::writeUint8Array(const uint8_t* Values, size_t Count) {
+  while (Count > 0) {
+    size_t Size = std::min(Count, WritePos.getContiguousBytesAvailable());
+    if (Size == 0) {
+      // At a page boundary, let the cursor advance to the next page.
+      Stream->writeUint8(*Values++, WritePos);
+      --Count;
+      continue;
+    }
+    memcpy(WritePos.getBufferPtr(), Values, Size);
+    WritePos.consumeContiguousBytes(Size);
+    Values += Size;
+    Count -= Size;
+  }
+  return WritePos.isQueueGood();
+}
+
+bool ByteWriter::writeVaruint32Array(const uint32_t* Values, size_t Count) {
+  Stream->writeVaruint32Array(Values, Count, WritePos);
+  return WritePos.isQueueGood();
+}
+
+bool ByteWriter::writeValue(IntType Value, const Node* Format) {
+  return writeFormattedValue(*this, Value, Format);
+}
+
 bool ByteWriter::writeFreezeEof() {
   WritePos.freezeEof();
   return WritePos.isQueueGood();
@@ -185,12 +357,19 @@ bool ByteWriter::writeBinary(IntType Value, const Node* Encoding) {
   const auto* Accept = cast<BinaryAccept>(Enc);
   unsigned NumBits = Accept->getNumBits();
   IntType Bits = Accept->getValue();
+  // Note: The path is stored least significant bit first, while writeBits()
+  // expects the most significant bit first. Hence, reverse while buffering.
   while (NumBits) {
-    --NumBits;
-    WritePos.writeBit(uint8_t(Bits & 0x1));
-    Bits >>= 1;
+    unsigned Count = std::min(NumBits, kBitsInWord);
+    BitWriteCursor::WordType Word = 0;
+    for (unsigned i = 0; i < Count; ++i) {
+      Word = (Word << 1) | BitWriteCursor::WordType(Bits & 0x1);
+      Bits >>= 1;
+    }
+    WritePos.writeBits(Word, Count);
+    NumBits -= Count;
   }
-  return true;
+  return WritePos.isQueueGood();
 }
 
 bool ByteWriter::alignToByte() {
@@ -202,6 +381,12 @@ bool ByteWriter::writeBlockEnter() {
   // Force alignment before processing, in case non-byte encodings
   // are used.
   alignToByte();
+  if (MinimizeBlockSize && PrecomputeBlockSizes) {
+    if (SizeHandler == nullptr)
+      SizeHandler = new BlockSizeHandler(*this);
+    if (SizeHandler->blockEnter())
+      return true;
+  }
   BlockStartStack.push(WritePos);
   Stream->writeFixedBlockSize(WritePos, 0);
   BlockStartStack.push(WritePos);
@@ -212,6 +397,8 @@ bool ByteWriter::writeBlockExit() {
   // Force alignment before processing, in case non-byte encodings
   // are used.
   WritePos.alignToByte();
+  if (SizeHandler && SizeHandler->blockExit())
+    return true;
   if (MinimizeBlockSize) {
     // Mimimized block. Backpatch new size of block. If needed, move
     // block to fill gap between fixed and variable widths for block
@@ -31,7 +31,7 @@ namespace interp {
 
 class WriteStream;
 
-class ByteWriter : public Writer {
+class ByteWriter FINAL : public Writer {
   ByteWriter() = delete;
   ByteWriter(const ByteWriter&) = delete;
   ByteWriter& operator=(const ByteWriter&) = delete;
@@ -43,9 +43,18 @@ class ByteWriter : public Writer {
 
   decode::BitWriteCursor& getPos();
   void setPos(const decode::BitWriteCursor& NewPos);
+  // When true (and minimizing block sizes), blocks are collected in a
+  // scratch queue until the outermost block exits, and then written out
+  // with their (precomputed) sizes. This avoids moving the contents of each
+  // (nested) block when its size is backpatched.
+  void setPrecomputeBlockSizes(bool NewValue) {
+    PrecomputeBlockSizes = NewValue;
+  }
   void reset() OVERRIDE;
   decode::StreamType getStreamType() const OVERRIDE;
+  decode::WriteCursor* getBytePos() OVERRIDE;
   bool writeBit(uint8_t Value) OVERRIDE;
+  bool writeBits(uint32_t Value, unsigned Count) OVERRIDE;
   bool writeUint8(uint8_t Value) OVERRIDE;
   bool writeUint32(uint32_t Value) OVERRIDE;
   bool writeUint64(uint64_t Value) OVERRIDE;
@@ -53,6 +62,9 @@ class ByteWriter : public Writer {
   bool writeVarint64(int64_t Value) OVERRIDE;
   bool writeVaruint32(uint32_t Value) OVERRIDE;
   bool writeVaruint64(uint64_t Value) OVERRIDE;
+  bool writeUint8Array(const uint8_t* Values, size_t Count) OVERRIDE;
+  bool writeVaruint32Array(const uint32_t* Values, size_t Count) OVERRIDE;
+  bool writeValue(decode::IntType Value, const filt::Node* Format) OVERRIDE;
   bool alignToByte() OVERRIDE;
   bool writeBlockEnter() OVERRIDE;
   bool writeBlockExit() OVERRIDE;
@@ -65,6 +77,7 @@ class ByteWriter : public Writer {
 
  private:
   class TableHandler;
+  class BlockSizeHandler;
 
   decode::BitWriteCursor WritePos;
   std::shared_ptr<WriteStream> Stream;
@@ -74,6 +87,8 @@ class ByteWriter : public Writer {
   void describeBlockStartStack(FILE* File);
   const char* getDefaultTraceName() const OVERRIDE;
   TableHandler* TblHandler;
+  BlockSizeHandler* SizeHandler;
+  bool PrecomputeBlockSizes;
 };
 
 }  // end of namespace interp
@@ -0,0 +1,83 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines the opcodes of the (flat) bytecode the interpreter evaluates
+// algorithm definitions with.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_BYTECODE_DEFS_H_
+#define DECOMPRESSOR_SRC_INTERP_BYTECODE_DEFS_H_
+
+// Note: Acc is the accumulator (i.e. value of the last evaluated
+// expression). Opcodes that consume input check that there is enough
+// (buffered) input before being applied.
+//
+//#define X(tag, reads_input)
+#define BYTECODE_OPCODES_TABLE                                               \
+  /* Applies action Arg to the input and output. */                          \
+  X(Action, true)                                                            \
+  /* Reads/writes Nd (a binary encoding), using mode flags Arg. */           \
+  X(Binary, true)                                                            \
+  /* Enters a block. */                                                      \
+  X(BlockEnter, true)                                                        \
+  /* Exits a block. */                                                       \
+  X(BlockExit, true)                                                         \
+  /* Acc = (popped value) op Acc. */                                         \
+  X(BitwiseAnd, false)                                                       \
+  X(BitwiseOr, false)                                                        \
+  X(BitwiseXor, false)                                                       \
+  X(BitwiseNegate, false)                                                    \
+  /* Evaluates Nd with the tree walker, using mode flags Arg. */             \
+  X(CallTree, false)                                                         \
+  /* Acc = Arg. */                                                           \
+  X(Const, false)                                                            \
+  /* Copies the (remaining) bytes of the input block to the output. */       \
+  X(CopyBlock, true)                                                         \
+  /* Acc = local Arg of the enclosing definition. */                         \
+  X(GetLocal, false)                                                         \
+  /* Jumps to Arg. */                                                        \
+  X(Jump, false)                                                             \
+  /* Jumps to Arg if at the end of the input block. */                       \
+  X(JumpIfEob, false)                                                        \
+  X(JumpIfNonZero, false)                                                    \
+  X(JumpIfZero, false)                                                       \
+  /* Acc = LastReadValue. */                                                 \
+  X(LastRead, false)                                                         \
+  /* LastReadValue = Acc = Arg. */                                           \
+  X(Literal, false)                                                          \
+  /* Pushes Acc as the loop count. */                                        \
+  X(LoopEnter, false)                                                        \
+  /* Decrements loop count, jumping to Arg (and popping) when done. */       \
+  X(LoopNext, false)                                                         \
+  /* Applies the entered loop to Nd (an integer format), using mode flags    \
+     Arg. Values are read (and written) in batches, popping the loop count   \
+     when done. */                                                           \
+  X(LoopValue, true)                                                         \
+  X(PopPeekPos, false)                                                       \
+  /* Pushes Acc (i.e. the left operand of a binary operator). */             \
+  X(Push, false)                                                             \
+  X(PushPeekPos, false)                                                      \
+  /* Returns Acc to the caller. */                                           \
+  X(Return, false)                                                           \
+  /* Sets local Arg to Acc. Acc = LastReadValue. */                          \
+  X(SetLocal, false)                                                         \
+  /* LastReadValue = Acc. */                                                 \
+  X(SetLastRead, false)                                                      \
+  /* Jumps to the target of Acc in jump table Arg. */                        \
+  X(Switch, false)                                                           \
+  /* Reads/writes Nd (an integer format), using mode flags Arg. */           \
+  X(Value, true)
+
+#endif  // DECOMPRESSOR_SRC_INTERP_BYTECODE_DEFS_H_
@@ -0,0 +1,345 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements the compiler of algorithm definitions to (flat) bytecode.
+
+#include "interp/Bytecode.h"
+
+#include "sexp/Ast.h"
+#include "sexp/TextWriter.h"
+#include "utils/Casting.h"
+
+namespace wasm {
+
+using namespace decode;
+using namespace filt;
+using namespace utils;
+
+namespace interp {
+
+namespace {
+
+const char* OpcodeName[] = {
+#define X(tag, reads_input) #tag,
+    BYTECODE_OPCODES_TABLE
+#undef X
+    "NO_SUCH_OPCODE"};
+
+const bool OpcodeReadsInput[] = {
+#define X(tag, reads_input) reads_input,
+    BYTECODE_OPCODES_TABLE
+#undef X
+    false};
+
+// Returns the integer format read by loop body Body, if Body consists of a
+// single read of an integer format (and hence the loop can be applied in
+// bulk). Otherwise returns nullptr.
+const Node* getLoopValueFormat(const Node* Body, uint32_t ModeFlags) {
+  if ((ModeFlags & Bytecode::ReadFlag) == 0)
+    return nullptr;
+  if (isa<Sequence>(Body) && Body->getNumKids() == 1)
+    Body = Body->getKid(0);
+  switch (Body->getType()) {
+    case NodeType::Uint32:
+    case NodeType::Uint64:
+    case NodeType::Uint8:
+    case NodeType::Varint32:
+    case NodeType::Varint64:
+    case NodeType::Varuint32:
+    case NodeType::Varuint64:
+      return Body;
+    default:
+      return nullptr;
+  }
+}
+
+}  // end of anonymous namespace
+
+class Bytecode::Compiler {
+  Compiler() = delete;
+  Compiler(const Compiler&) = delete;
+  Compiler& operator=(const Compiler&) = delete;
+
+ public:
+  explicit Compiler(Bytecode& BC) : BC(BC) {}
+  void compile(const Node* Nd, uint32_t ModeFlags);
+
+ private:
+  Bytecode& BC;
+
+  size_t getPc() const { return BC.Code.size(); }
+  size_t emit(Opcode Op, IntType Arg = 0, const Node* Nd = nullptr) {
+    BC.Code.emplace_back(Op, Arg, Nd);
+    return BC.Code.size() - 1;
+  }
+  // Resolves the (forward) jump at Index to the current pc.
+  void setTarget(size_t Index) { BC.Code[Index].Arg = getPc(); }
+  void compileSwitch(const Switch* Sel, uint32_t ModeFlags);
+};
+
+void Bytecode::Compiler::compile(const Node* Nd, uint32_t ModeFlags) {
+  const bool HasReadMode = ModeFlags & ReadFlag;
+  switch (Nd->getType()) {
+    default:
+      // Includes nodes that depend on the calling context (such as
+      // parameters and calls), and nodes that are rarely evaluated.
+      emit(Opcode::CallTree, ModeFlags, Nd);
+      return;
+    case NodeType::Sequence:
+      for (int i = 0; i < Nd->getNumKids(); ++i)
+        compile(Nd->getKid(i), ModeFlags);
+      emit(Opcode::LastRead);
+      return;
+    case NodeType::Loop: {
+      compile(Nd->getKid(0), ModeFlags);
+      emit(Opcode::LoopEnter);
+      if (const Node* Format = getLoopValueFormat(Nd->getKid(1), ModeFlags)) {
+        // Loops over a single value (such as the bytes of a data segment)
+        // are applied in bulk.
+        emit(Opcode::LoopValue, ModeFlags, Format);
+        emit(Opcode::Const, 0);
+        return;
+      }
+      size_t Top = emit(Opcode::LoopNext);
+      compile(Nd->getKid(1), ModeFlags);
+      emit(Opcode::Jump, Top);
+      setTarget(Top);
+      emit(Opcode::Const, 0);
+      return;
+    }
+    case NodeType::LoopUnbounded: {
+      const Node* Format = getLoopValueFormat(Nd->getKid(0), ModeFlags);
+      if (Format != nullptr && Format->getType() == NodeType::Uint8 &&
+          (ModeFlags & WriteFlag)) {
+        // Copies the bytes of the block (such as a skipped section) directly.
+        emit(Opcode::CopyBlock);
+        emit(Opcode::Const, 0);
+        return;
+      }
+      size_t Top = emit(Opcode::JumpIfEob);
+      compile(Nd->getKid(0), ModeFlags);
+      emit(Opcode::Jump, Top);
+      setTarget(Top);
+      emit(Opcode::Const, 0);
+      return;
+    }
+    case NodeType::IfThen: {
+      compile(Nd->getKid(0), ModeFlags);
+      size_t Skip = emit(Opcode::JumpIfZero);
+      compile(Nd->getKid(1), ModeFlags);
+      setTarget(Skip);
+      emit(Opcode::Const, 0);
+      return;
+    }
+    case NodeType::IfThenElse: {
+      compile(Nd->getKid(0), ModeFlags);
+      size_t Else = emit(Opcode::JumpIfZero);
+      compile(Nd->getKid(1), ModeFlags);
+      size_t End = emit(Opcode::Jump);
+      setTarget(Else);
+      compile(Nd->getKid(2), ModeFlags);
+      setTarget(End);
+      emit(Opcode::Const, 0);
+      return;
+    }
+    case NodeType::Switch:
+      compileSwitch(cast<Switch>(Nd), ModeFlags);
+      return;
+    case NodeType::Case:
+      compile(cast<Case>(Nd)->getCaseBody(), ModeFlags);
+      emit(Opcode::SetLastRead);
+      return;
+    case NodeType::And:
+    case NodeType::Or: {
+      if (!HasReadMode)
+        break;
+      compile(Nd->getKid(0), ModeFlags);
+      size_t Skip = emit(Nd->getType() == NodeType::And
+                             ? Opcode::JumpIfZero
+                             : Opcode::JumpIfNonZero);
+      compile(Nd->getKid(1), ModeFlags);
+      setTarget(Skip);
+      return;
+    }
+    case NodeType::Not:
+      if (!HasReadMode)
+        break;
+      compile(Nd->getKid(0), ModeFlags);
+      return;
+    case NodeType::BitwiseAnd:
+    case NodeType::BitwiseOr:
+    case NodeType::BitwiseXor: {
+      if (!HasReadMode)
+        break;
+      compile(Nd->getKid(0), ModeFlags);
+      emit(Opcode::Push);
+      compile(Nd->getKid(1), ModeFlags);
+      Opcode Op = Opcode::BitwiseXor;
+      if (Nd->getType() == NodeType::BitwiseAnd)
+        Op = Opcode::BitwiseAnd;
+      else if (Nd->getType() == NodeType::BitwiseOr)
+        Op = Opcode::BitwiseOr;
+      emit(Op);
+      return;
+    }
+    case NodeType::BitwiseNegate:
+      if (!HasReadMode)
+        break;
+      compile(Nd->getKid(0), ModeFlags);
+      emit(Opcode::BitwiseNegate);
+      return;
+    case NodeType::Read:
+      compile(Nd->getKid(0), ReadFlag);
+      return;
+    case NodeType::Write:
+      if (Nd->getNumKids() == 1) {
+        emit(Opcode::Const, 0);
+        return;
+      }
+      for (int i = 1; i < Nd->getNumKids(); ++i) {
+        compile(Nd->getKid(i), ReadFlag);
+        compile(Nd->getKid(0), WriteFlag);
+      }
+      return;
+    case NodeType::Peek:
+      emit(Opcode::PushPeekPos);
+      compile(Nd->getKid(0), ReadFlag);
+      emit(Opcode::PopPeekPos);
+      return;
+    case NodeType::Bit:
+    case NodeType::Uint32:
+    case NodeType::Uint64:
+    case NodeType::Uint8:
+    case NodeType::Varint32:
+    case NodeType::Varint64:
+    case NodeType::Varuint32:
+    case NodeType::Varuint64:
+      emit(Opcode::Value, ModeFlags, Nd);
+      return;
+    case NodeType::BinaryEval:
+      emit(Opcode::Binary, ModeFlags, Nd);
+      return;
+    case NodeType::I32Const:
+    case NodeType::I64Const:
+    case NodeType::One:
+    case NodeType::U8Const:
+    case NodeType::U32Const:
+    case NodeType::U64Const:
+    case NodeType::Zero:
+      emit(HasReadMode ? Opcode::Literal : Opcode::Const,
+           cast<IntegerNode>(Nd)->getValue());
+      return;
+    case NodeType::LastRead:
+    case NodeType::Void:
+      emit(Opcode::LastRead);
+      return;
+    case NodeType::Local:
+      emit(Opcode::GetLocal, cast<Local>(Nd)->getValue());
+      return;
+    case NodeType::Set: {
+      const auto* L = dyn_cast<Local>(Nd->getKid(0));
+      if (L == nullptr)
+        break;
+      compile(Nd->getKid(1), ModeFlags);
+      emit(Opcode::SetLocal, L->getValue());
+      return;
+    }
+    case NodeType::Callback:
+      emit(Opcode::Action, cast<Callback>(Nd)->getIntNode()->getValue());
+      return;
+    case NodeType::Block:
+      emit(Opcode::BlockEnter);
+      compile(Nd->getKid(0), ModeFlags);
+      emit(Opcode::BlockExit);
+      emit(Opcode::Const, 0);
+      return;
+  }
+  // Let the interpreter generate the corresponding error.
+  emit(Opcode::CallTree, ModeFlags, Nd);
+}
+
+void Bytecode::Compiler::compileSwitch(const Switch* Sel, uint32_t ModeFlags) {
+  compile(Sel->getKid(0), ModeFlags);
+  size_t TableIndex = BC.JumpTables.size();
+  BC.JumpTables.emplace_back();
+  emit(Opcode::Switch, TableIndex);
+  std::vector<size_t> Exits;
+  for (int i = 2; i < Sel->getNumKids(); ++i) {
+    const auto* C = dyn_cast<Case>(Sel->getKid(i));
+    if (C == nullptr)
+      continue;
+    // Note: Nested cases share the same case body. Only cases installed
+    // in the switch are reachable.
+    bool IsReachable = false;
+    for (const Node* Nd = C; isa<Case>(Nd); Nd = Nd->getKid(1)) {
+      const auto* Key = cast<Case>(Nd);
+      if (Sel->getCase(Key->getValue()) != Key)
+        continue;
+      BC.JumpTables[TableIndex].Targets.add(Key->getValue(), getPc());
+      IsReachable = true;
+    }
+    if (!IsReachable)
+      continue;
+    compile(C, ModeFlags);
+    Exits.push_back(emit(Opcode::Jump));
+  }
+  BC.JumpTables[TableIndex].Targets.setDefault(getPc());
+  compile(Sel->getKid(1), ModeFlags);
+  for (size_t Exit : Exits)
+    setTarget(Exit);
+  emit(Opcode::Const, 0);
+}
+
+Bytecode::Bytecode() {}
+
+Bytecode::~Bytecode() {}
+
+const char* Bytecode::getName(Opcode Op) {
+  size_t Index = size_t(Op);
+  if (Index >= size(OpcodeName))
+    Index = size_t(Opcode::NO_SUCH_OPCODE);
+  return OpcodeName[Index];
+}
+
+bool Bytecode::readsInput(Opcode Op) {
+  return OpcodeReadsInput[size_t(Op)];
+}
+
+std::unique_ptr<Bytecode> Bytecode::compile(const Node* Nd,
+                                            uint32_t ModeFlags) {
+  std::unique_ptr<Bytecode> BC(new Bytecode());
+  Compiler(*BC).compile(Nd, ModeFlags);
+  BC->Code.emplace_back(Opcode::Return, 0, nullptr);
+  return BC;
+}
+
+void Bytecode::describe(FILE* File, TextWriter* Writer) const {
+  for (size_t i = 0; i < Code.size(); ++i) {
+    const Instruction& Inst = Code[i];
+    fprintf(File, "%4" PRIuMAX ": %s %" PRIuMAX, uintmax_t(i),
+            getName(Inst.Op), uintmax_t(Inst.Arg));
+    if (Inst.Nd) {
+      fputs(" ", File);
+      Writer->writeAbbrev(File, Inst.Nd);
+    } else {
+      fputc('\n', File);
+    }
+  }
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
@@ -0,0 +1,100 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a flat bytecode that the body of an algorithm definition is
+// compiled to. Jump targets are resolved at compile time, so that the
+// interpreter can evaluate the body without pushing a call frame for each
+// node in the body. Nodes that can't be compiled are evaluated by calling
+// back into the interpreter (see opcode CallTree).
+
+#ifndef DECOMPRESSOR_SRC_INTERP_BYTECODE_H_
+#define DECOMPRESSOR_SRC_INTERP_BYTECODE_H_
+
+#include <memory>
+#include <vector>
+
+#include "interp/Bytecode-defs.h"
+#include "utils/Defs.h"
+#include "utils/DenseIntMap.h"
+
+namespace wasm {
+
+namespace filt {
+class Node;
+class TextWriter;
+}  // end of namespace filt
+
+namespace interp {
+
+class Bytecode {
+  Bytecode(const Bytecode&) = delete;
+  Bytecode& operator=(const Bytecode&) = delete;
+
+ public:
+  enum class Opcode : uint8_t {
+#define X(tag, reads_input) tag,
+    BYTECODE_OPCODES_TABLE
+#undef X
+        NO_SUCH_OPCODE
+  };
+  static const char* getName(Opcode Op);
+  static bool readsInput(Opcode Op);
+
+  // Mode flags. Note: Matches the flags of interpreter method modifiers.
+  static constexpr uint32_t ReadFlag = 0x1;
+  static constexpr uint32_t WriteFlag = 0x2;
+
+  struct Instruction {
+    Instruction(Opcode Op, decode::IntType Arg, const filt::Node* Nd)
+        : Op(Op), Arg(Arg), Nd(Nd) {}
+    Opcode Op;
+    decode::IntType Arg;
+    const filt::Node* Nd;
+  };
+
+  struct JumpTable {
+    // Maps case keys to targets. Unknown keys map to the default target.
+    utils::DenseIntMap<decode::IntType, size_t> Targets;
+    JumpTable() : Targets(0) {}
+    size_t getTarget(decode::IntType Key) const { return Targets.get(Key); }
+  };
+
+  ~Bytecode();
+
+  // Compiles the evaluation of Nd, using the given mode flags.
+  static std::unique_ptr<Bytecode> compile(const filt::Node* Nd,
+                                           uint32_t ModeFlags);
+
+  const Instruction* getCode() const { return Code.data(); }
+  size_t getSize() const { return Code.size(); }
+  const JumpTable& getJumpTable(size_t Index) const {
+    return JumpTables[Index];
+  }
+
+  void describe(FILE* File, filt::TextWriter* Writer) const;
+
+ private:
+  class Compiler;
+  std::vector<Instruction> Code;
+  std::vector<JumpTable> JumpTables;
+  Bytecode();
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_BYTECODE_H_
@@ -21,11 +21,13 @@
 #include "algorithms/wasm0xd.h"
 #include "interp/ByteReader.h"
 #include "interp/ByteWriter.h"
+#include "interp/DecompressIndex.h"
 #include "interp/DecompressSelector.h"
+#include "interp/FunctionObserverWriter.h"
 #include "interp/Interpreter.h"
+#include "sexp/Ast.h"
 #include "stream/Pipe.h"
 #include "stream/Queue.h"
-#include "stream/WriteCursor2ReadQueue.h"
 
 namespace wasm {
 
@@ -37,28 +39,153 @@ namespace interp {
 
 namespace {
 
+// Edits the integer stream of a group of function bodies (see
+// DecompressIndex.h), so that the final algorithm can convert it to
+// binary. That is, replaces the number of function bodies in the enclosing
+// section with the number in the group, and closes the section once the
+// input is exhausted.
+class FunctionGroupWriter : public ForwardingWriter {
+  FunctionGroupWriter() = delete;
+  FunctionGroupWriter(const FunctionGroupWriter&) = delete;
+  FunctionGroupWriter& operator=(const FunctionGroupWriter&) = delete;
+
+ public:
+  // Note: HasCount is true if the group begins with the number of function
+  // bodies in the section (i.e. is the first group of the section).
+  FunctionGroupWriter(std::shared_ptr<Writer> Output,
+                      IntType NumFunctions,
+                      bool HasCount)
+      : ForwardingWriter(Output),
+        NumFunctions(NumFunctions),
+        HasCount(HasCount),
+        SkipCount(false),
+        Depth(0) {}
+  ~FunctionGroupWriter() OVERRIDE {}
+
+  void reset() OVERRIDE {
+    Output->reset();
+    SkipCount = false;
+    Depth = 0;
+  }
+  bool writeUint8(uint8_t Value) OVERRIDE {
+    return skipCount() || Output->writeUint8(Value);
+  }
+  bool writeUint32(uint32_t Value) OVERRIDE {
+    return skipCount() || Output->writeUint32(Value);
+  }
+  bool writeUint64(uint64_t Value) OVERRIDE {
+    return skipCount() || Output->writeUint64(Value);
+  }
+  bool writeVarint32(int32_t Value) OVERRIDE {
+    return skipCount() || Output->writeVarint32(Value);
+  }
+  bool writeVarint64(int64_t Value) OVERRIDE {
+    return skipCount() || Output->writeVarint64(Value);
+  }
+  bool writeVaruint32(uint32_t Value) OVERRIDE {
+    return skipCount() || Output->writeVaruint32(Value);
+  }
+  bool writeVaruint64(uint64_t Value) OVERRIDE {
+    return skipCount() || Output->writeVaruint64(Value);
+  }
+  bool writeValue(IntType Value, const filt::Node* Format) OVERRIDE {
+    return skipCount() || Output->writeValue(Value, Format);
+  }
+  bool writeTypedValue(IntType Value, IntTypeFormat Format) OVERRIDE {
+    return skipCount() || Output->writeTypedValue(Value, Format);
+  }
+  bool writeBlockEnter() OVERRIDE {
+    if (!Output->writeBlockEnter())
+      return false;
+    if (Depth++ > 0)
+      return true;
+    // Entered the enclosing section.
+    SkipCount = HasCount;
+    return Output->writeVaruint64(NumFunctions);
+  }
+  bool writeBlockExit() OVERRIDE {
+    if (Depth > 0)
+      --Depth;
+    return Output->writeBlockExit();
+  }
+  bool writeFreezeEof() OVERRIDE {
+    // Note: The input ends before the enclosing section does.
+    for (; Depth > 0; --Depth)
+      if (!Output->writeBlockExit())
+        return false;
+    return Output->writeFreezeEof();
+  }
+  bool writeAction(IntType Action) OVERRIDE {
+    switch (Action) {
+      case IntType(PredefinedSymbol::Block_enter):
+      case IntType(PredefinedSymbol::Block_enter_writeonly):
+        return writeBlockEnter();
+      case IntType(PredefinedSymbol::Block_exit):
+      case IntType(PredefinedSymbol::Block_exit_writeonly):
+        return writeBlockExit();
+      default:
+        return Output->writeAction(Action);
+    }
+  }
+
+ private:
+  IntType NumFunctions;
+  bool HasCount;
+  bool SkipCount;
+  size_t Depth;
+
+  bool skipCount() {
+    if (!SkipCount)
+      return false;
+    SkipCount = false;
+    return true;
+  }
+};
+
 struct Decompressor {
   Decompressor(const Decompressor& D) = delete;
   Decompressor& operator=(const Decompressor& D) = delete;
 
  public:
-  enum class State { NeedsMoreInput, FlushingOutput, Succeeded, Failed };
+  enum class State {
+    NeedsMoreInput,
+    InProgress,
+    FlushingOutput,
+    Succeeded,
+    Failed
+  };
   std::unique_ptr<uint8_t> Buffer;
   int32_t BufferSize;
   std::shared_ptr<SymbolTable> Symtab;
   std::shared_ptr<Queue> Input;
-  std::shared_ptr<WriteCursor2ReadQueue> InputPos;
+  // Address in Input to add the next input bytes.
+  AddressType InputAddress;
   Pipe OutputPipe;
   std::shared_ptr<ReadCursor> OutputPos;
   std::shared_ptr<Interpreter> MyReader;
   std::shared_ptr<ByteWriter> Writer;
+  std::shared_ptr<FunctionObserverWriter> Observer;
   std::shared_ptr<DecompAlgState> AlgState;
   State MyState;
   InterpreterFlags Flags;
   Decompressor();
   uint8_t* getBuffer(int32_t Size);
-  int32_t resume(int32_t Size);
+  int32_t resume(int32_t Size, int32_t Budget = 0);
+  int32_t resume(const uint8_t* Bytes, int32_t Size, int32_t Budget);
+  int32_t decompressInto(const uint8_t* In,
+                         int32_t InSize,
+                         uint8_t* Out,
+                         int32_t OutCapacity,
+                         int32_t& Consumed,
+                         int32_t& Produced);
   void closeInput();
+  bool setFunctionCallback(decompressor_function_callback Callback,
+                           void* Data);
+  int32_t decompressEntry(const uint8_t* Compressed,
+                          int32_t CompressedSize,
+                          const uint8_t* IndexBytes,
+                          int32_t IndexSize,
+                          int32_t EntryIndex);
   bool fetchOutput(int32_t Size);
   int32_t getOutputSize() {
     return OutputPipe.getOutput()->fillSize() - OutputPos->getCurAddress();
@@ -68,6 +195,11 @@ struct Decompressor {
 
  private:
   int32_t flushOutput();
+  void addInput(const uint8_t* Bytes, size_t Size);
+  void readOutput(uint8_t* Bytes, int32_t Size);
+  int32_t decompressInput(int32_t Budget);
+  bool skipOutputVaruint32();
+  bool skipOutputHeader(DecompressIndex::EntryKind Kind);
   int32_t fail() {
     MyState = State::Failed;
     return DECOMPRESSOR_ERROR;
@@ -77,15 +209,15 @@ struct Decompressor {
 Decompressor::Decompressor()
     : BufferSize(0),
       Input(std::make_shared<Queue>()),
+      InputAddress(0),
       AlgState(std::make_shared<DecompAlgState>()),
       MyState(State::NeedsMoreInput) {
-  InputPos = std::make_shared<WriteCursor2ReadQueue>(Input);
   OutputPos = std::make_shared<ReadCursor>(OutputPipe.getOutput());
 }
 
 uint8_t* Decompressor::getBuffer(int32_t Size) {
   TRACE_METHOD("get_decompressor_buffer");
-  TRACE(bool, "AtEof", InputPos->atEof());
+  TRACE(bool, "AtEof", Input->isEofFrozen());
   if (Size <= BufferSize)
     return Buffer.get();
   Buffer.reset(new uint8_t[Size]);
@@ -101,43 +233,87 @@ int32_t Decompressor::flushOutput() {
   return DECOMPRESSOR_SUCCESS;
 }
 
-int32_t Decompressor::resume(int32_t Size) {
+void Decompressor::addInput(const uint8_t* Bytes, size_t Size) {
+  if (Size > 0 && !Input->write(InputAddress, Bytes, Size))
+    MyReader->throwMessage("Unable to add input to decompressor");
+}
+
+void Decompressor::readOutput(uint8_t* Bytes, int32_t Size) {
+  // Copy (contiguous) bytes of output pages directly, when possible.
+  while (Size > 0) {
+    size_t Count = OutputPos->getContiguousBytesAvailable();
+    if (Count == 0) {
+      *Bytes++ = OutputPos->readByte();
+      --Size;
+      continue;
+    }
+    if (Count > size_t(Size))
+      Count = Size;
+    memcpy(Bytes, OutputPos->getBufferPtr(), Count);
+    OutputPos->consumeContiguousBytes(Count);
+    Bytes += Count;
+    Size -= Count;
+  }
+}
+
+int32_t Decompressor::decompressInput(int32_t Budget) {
+  MyReader->setStepBudget(Budget > 0 ? size_t(Budget) : 0);
+  MyReader->algorithmResume();
+  if (MyReader->errorsFound())
+    return fail();
+  if (!MyReader->isFinished()) {
+    if (MyReader->stepBudgetUsedUp()) {
+      MyState = State::InProgress;
+      return DECOMPRESSOR_IN_PROGRESS;
+    }
+    MyState = State::NeedsMoreInput;
+    return getOutputSize();
+  }
+  OutputPipe.getInput()->close();
+  if (!MyReader->isSuccessful())
+    return fail();
+  MyState = State::FlushingOutput;
+  return flushOutput();
+}
+
+int32_t Decompressor::resume(int32_t Size, int32_t Budget) {
+  if (MyState == State::NeedsMoreInput && Size > BufferSize) {
+    MyReader->throwMessage("resume_decompression(" + std::to_string(Size) +
+                           "): illegal size");
+    return fail();
+  }
+  return resume(Buffer.get(), Size, Budget);
+}
+
+int32_t Decompressor::resume(const uint8_t* Bytes,
+                             int32_t Size,
+                             int32_t Budget) {
   TRACE_METHOD("resume_decompression");
   switch (MyState) {
     case State::NeedsMoreInput:
       if (Size == 0) {
-        if (!InputPos->atEof()) {
+        if (!Input->isEofFrozen()) {
           TRACE_MESSAGE("Closing input");
-          InputPos->freezeEof();
-          InputPos->close();
+          Input->freezeEof(InputAddress);
         }
       } else {
-        if (InputPos->atEof()) {
+        if (Input->isEofFrozen()) {
           MyReader->throwMessage("resume_decompression(" +
                                  std::to_string(Size) +
                                  "): can't add bytes when input closed");
           return fail();
         }
-        if (Size > BufferSize) {
-          MyReader->throwMessage("resume_decompression(" +
-                                 std::to_string(Size) + "): illegal size");
-          return fail();
-        }
-        // TODO(karlschimpf) Speed up this copy.
-        uint8_t* Buf = Buffer.get();
-        for (int32_t i = 0; i < Size; ++i)
-          InputPos->writeByte(Buf[i]);
+        addInput(Bytes, Size);
       }
-      MyReader->algorithmResume();
-      if (MyReader->errorsFound())
-        return fail();
-      if (!MyReader->isFinished())
-        return getOutputSize();
-      OutputPipe.getInput()->close();
-      if (!MyReader->isSuccessful())
+      return decompressInput(Budget);
+    case State::InProgress:
+      if (Size != 0) {
+        MyReader->throwMessage("resume_decompression(" +
+                               std::to_string(Size) +
+                               "): can't add bytes while still in progress");
         return fail();
-      MyState = State::FlushingOutput;
-      return flushOutput();
+      }
+      return decompressInput(Budget);
     case State::FlushingOutput:
       return flushOutput();
     case State::Succeeded:
@@ -152,6 +328,104 @@ int32_t Decompressor::resume(int32_t Size) {
   return DECOMPRESSOR_ERROR;
 }
 
+bool Decompressor::setFunctionCallback(decompressor_function_callback Callback,
+                                       void* Data) {
+  if (MyState != State::NeedsMoreInput || InputAddress != 0 || Observer)
+    return false;
+  Observer = std::make_shared<FunctionObserverWriter>(
+      Writer,
+      [=](size_t Index, AddressType Begin, AddressType End,
+          const uint8_t* Body) {
+        Callback(Data, int32_t(Index), Body, int32_t(Begin), int32_t(End));
+      });
+  Observer->setInterpreter(MyReader.get());
+  MyReader->setWriter(Observer);
+  return true;
+}
+
+bool Decompressor::skipOutputVaruint32() {
+  for (int i = 0; i < 5; ++i) {
+    if (getOutputSize() == 0)
+      return false;
+    if ((OutputPos->readByte() & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+bool Decompressor::skipOutputHeader(DecompressIndex::EntryKind Kind) {
+  // Skip the module header (magic number and version).
+  constexpr int32_t ModuleHeaderSize = 8;
+  if (getOutputSize() < ModuleHeaderSize)
+    return false;
+  for (int32_t i = 0; i < ModuleHeaderSize; ++i)
+    OutputPos->readByte();
+  if (Kind == DecompressIndex::EntryKind::Section)
+    return true;
+  // Skip the section code, size, and number of function bodies.
+  return skipOutputVaruint32() && skipOutputVaruint32() &&
+         skipOutputVaruint32();
+}
+
+int32_t Decompressor::decompressEntry(const uint8_t* Compressed,
+                                      int32_t CompressedSize,
+                                      const uint8_t* IndexBytes,
+                                      int32_t IndexSize,
+                                      int32_t EntryIndex) {
+  TRACE_METHOD("decompress_indexed_entry");
+  if (MyState != State::NeedsMoreInput || InputAddress != 0)
+    return fail();
+  DecompressIndex Index;
+  if (CompressedSize < 0 || IndexSize < 0 ||
+      !Index.read(IndexBytes, IndexSize) || EntryIndex < 0 ||
+      size_t(EntryIndex) >= Index.getNumEntries()) {
+    MyReader->throwMessage("decompress_indexed_entry(" +
+                           std::to_string(EntryIndex) + "): no such entry");
+    return fail();
+  }
+  const DecompressIndex::Entry& Entry = Index.getEntry(EntryIndex);
+  const DecompressIndex::Entry& Section =
+      Entry.Kind == DecompressIndex::EntryKind::Functions
+          ? Index.getEntry(Entry.Section)
+          : Entry;
+  if (Index.getBodyBegin() > Section.Begin ||
+      Entry.End > AddressType(CompressedSize) ||
+      Section.ContentBegin > AddressType(CompressedSize)) {
+    MyReader->throwMessage("decompress_indexed_entry(" +
+                           std::to_string(EntryIndex) +
+                           "): entry not within compressed file");
+    return fail();
+  }
+  // Decompress the range of the entry, as if it immediately followed the
+  // header of the compressed data.
+  addInput(Compressed, Index.getBodyBegin());
+  if (Entry.Kind == DecompressIndex::EntryKind::Functions) {
+    addInput(Compressed + Section.Begin, Section.ContentBegin - Section.Begin);
+    IntType NumFunctions = Entry.NumFunctions;
+    bool HasCount = Entry.FirstFunction == 0;
+    AlgState->setWrapFinalIntWriter(
+        [=](std::shared_ptr<interp::Writer> Output)
+            -> std::shared_ptr<interp::Writer> {
+          return std::make_shared<FunctionGroupWriter>(Output, NumFunctions,
+                                                       HasCount);
+        });
+  }
+  addInput(Compressed + Entry.Begin, Entry.End - Entry.Begin);
+  Input->freezeEof(InputAddress);
+  MyReader->algorithmResume();
+  OutputPipe.getInput()->close();
+  if (!MyReader->isFinished() || !MyReader->isSuccessful())
+    return fail();
+  if (!skipOutputHeader(Entry.Kind)) {
+    MyReader->throwMessage("decompress_indexed_entry(" +
+                           std::to_string(EntryIndex) +
+                           "): malformed output");
+    return fail();
+  }
+  MyState = State::FlushingOutput;
+  return flushOutput();
+}
+
 bool Decompressor::fetchOutput(int32_t Size) {
   TRACE_METHOD("fetch_decompressor_output");
   switch (MyState) {
@@ -165,11 +439,48 @@ bool Decompressor::fetchOutput(int32_t Size) {
     fail();
     return false;
   }
-  // TODO(karlschimpf): Do this more efficiently.
-  uint8_t* Buf = Buffer.get();
-  for (int32_t i = 0; i < Size; ++i)
-    Buf[i] = OutputPos->readByte();
-  return Size;
+  readOutput(Buffer.get(), Size);
+  return true;
+}
+
+int32_t Decompressor::decompressInto(const uint8_t* In,
+                                     int32_t InSize,
+                                     uint8_t* Out,
+                                     int32_t OutCapacity,
+                                     int32_t& Consumed,
+                                     int32_t& Produced) {
+  TRACE_METHOD("decompress_into");
+  Consumed = 0;
+  Produced = 0;
+  int32_t Status = DECOMPRESSOR_ERROR;
+  switch (MyState) {
+    case State::NeedsMoreInput:
+      // Only accept more input once all previous output has been taken.
+      if (getOutputSize() > 0)
+        break;
+      Status = resume(In, InSize, 0);
+      if (Status == DECOMPRESSOR_ERROR)
+        return Status;
+      Consumed = InSize;
+      break;
+    case State::InProgress:
+      Status = decompressInput(0);
+      if (Status == DECOMPRESSOR_ERROR)
+        return Status;
+      break;
+    case State::FlushingOutput:
+      break;
+    case State::Succeeded:
+      return DECOMPRESSOR_SUCCESS;
+    case State::Failed:
+      return DECOMPRESSOR_ERROR;
+  }
+  int32_t OutputSize = getOutputSize();
+  Produced = OutputSize < OutCapacity ? OutputSize : OutCapacity;
+  readOutput(Out, Produced);
+  if (MyState == State::FlushingOutput)
+    return flushOutput();
+  return getOutputSize();
 }
 
 }  // end of anonymous namespace
@@ -206,6 +517,71 @@ int32_t resume_decompression(void* Dptr, int32_t Size) {
   return D->resume(Size);
 }
 
+int32_t resume_decompression_with_budget(void* Dptr,
+                                         int32_t Size,
+                                         int32_t Budget) {
+  Decompressor* D = (Decompressor*)Dptr;
+  return D->resume(Size, Budget);
+}
+
+int32_t get_decompressor_output_size(void* Dptr) {
+  Decompressor* D = (Decompressor*)Dptr;
+  return D->getOutputSize();
+}
+
+int32_t decompress_into(void* Dptr,
+                        const uint8_t* In,
+                        int32_t InSize,
+                        uint8_t* Out,
+                        int32_t OutCapacity,
+                        int32_t* Consumed,
+                        int32_t* Produced) {
+  Decompressor* D = (Decompressor*)Dptr;
+  return D->decompressInto(In, InSize, Out, OutCapacity, *Consumed, *Produced);
+}
+
+bool set_decompressor_function_callback(
+    void* Dptr,
+    decompressor_function_callback Callback,
+    void* Data) {
+  Decompressor* D = (Decompressor*)Dptr;
+  return D->setFunctionCallback(Callback, Data);
+}
+
+int32_t decompress_indexed_entry(void* Dptr,
+                                 const uint8_t* Compressed,
+                                 int32_t CompressedSize,
+                                 const uint8_t* Index,
+                                 int32_t IndexSize,
+                                 int32_t Entry) {
+  Decompressor* D = (Decompressor*)Dptr;
+  return D->decompressEntry(Compressed, CompressedSize, Index, IndexSize,
+                            Entry);
+}
+
+int32_t get_decompressor_index_size(const uint8_t* Index, int32_t IndexSize) {
+  DecompressIndex MyIndex;
+  if (IndexSize < 0 || !MyIndex.read(Index, IndexSize))
+    return DECOMPRESSOR_ERROR;
+  return int32_t(MyIndex.getNumEntries());
+}
+
+int32_t find_decompressor_function_entry(const uint8_t* Index,
+                                         int32_t IndexSize,
+                                         int32_t Function) {
+  DecompressIndex MyIndex;
+  if (IndexSize < 0 || Function < 0 || !MyIndex.read(Index, IndexSize))
+    return DECOMPRESSOR_ERROR;
+  for (size_t i = 0; i < MyIndex.getNumEntries(); ++i) {
+    const DecompressIndex::Entry& Entry = MyIndex.getEntry(i);
+    if (Entry.Kind == DecompressIndex::EntryKind::Functions &&
+        size_t(Function) >= Entry.FirstFunction &&
+        size_t(Function) < Entry.FirstFunction + Entry.NumFunctions)
+      return int32_t(i);
+  }
+  return DECOMPRESSOR_ERROR;
+}
+
 bool fetch_decompressor_output(void* Dptr, int32_t Size) {
   Decompressor* D = (Decompressor*)Dptr;
   return D->fetchOutput(Size);
@@ -26,6 +26,7 @@ extern "C" {
 
 #define DECOMPRESSOR_SUCCESS (-1)
 #define DECOMPRESSOR_ERROR (-2)
+#define DECOMPRESSOR_IN_PROGRESS (-3)
 
 /* Returns an allocated and initialized decompressor. */
 extern void* create_decompressor();
@@ -46,6 +47,102 @@ extern void set_trace_decompression(void* D, bool NewValue);
  */
 extern int32_t resume_decompression(void* D, int32_t Size);
 
+/* Same as resume_decompression(), except that at most Budget (if positive)
+ * interpreter steps are run by each call. Bounds the work done by each call,
+ * independent of the number of input bytes (and of the number of compression
+ * layers). If the budget is used up before all input is decompressed,
+ * DECOMPRESSOR_IN_PROGRESS is returned. In that case, call again with
+ * Size == 0 to continue (output decompressed so far can be fetched in
+ * between, see get_decompressor_output_size()). Allows the caller to
+ * interleave decompression with other work. Note: The Size bytes are copied
+ * into the decompressor by the first call.
+ */
+extern int32_t resume_decompression_with_budget(void* D,
+                                                int32_t Size,
+                                                int32_t Budget);
+
+/* Returns the number of output bytes available to fetch using
+ * fetch_decompressor_output().
+ */
+extern int32_t get_decompressor_output_size(void* D);
+
+/* Decompresses from/to caller buffers. Copies the InSize bytes of In into the
+ * input queue, and then copies up to OutCapacity bytes of output (from the
+ * output queue) into Out. Compared to resume_decompression() and
+ * fetch_decompressor_output(), this saves one copy (through the decompressor
+ * buffer) in each direction. It is not zero-copy. On return,
+ * *Consumed is the number of input bytes used and *Produced is the number of
+ * output bytes written. Note: Input is only used once all previous output has
+ * been written. Hence, if *Consumed < InSize, call again with the remaining
+ * input. If non-negative, returns the number of output bytes still to be
+ * written. If negative, either DECOMPRESSOR_SUCCESS or DECOMPRESSOR_ERROR.
+ * NOTE: If InSize == 0 (and input is used), the code assumes that no more
+ * input will be provided.
+ */
+extern int32_t decompress_into(void* D,
+                               const uint8_t* In,
+                               int32_t InSize,
+                               uint8_t* Out,
+                               int32_t OutCapacity,
+                               int32_t* Consumed,
+                               int32_t* Produced);
+
+/* Called as soon as each function body has been decompressed. Index is the
+ * index of the function within the code section, and [Begin, End) is the
+ * range of the function body (including its size prefix) in the output.
+ * Body points to the (End - Begin) bytes of the function body, and is only
+ * valid during the call. Note: The function body can't be fetched (using
+ * fetch_decompressor_output()) until the enclosing code section has been
+ * decompressed, so use Body to process it early.
+ */
+typedef void (*decompressor_function_callback)(void* Data,
+                                               int32_t Index,
+                                               const uint8_t* Body,
+                                               int32_t Begin,
+                                               int32_t End);
+
+/* Installs Callback (with Data) to be called as each function body is
+ * decompressed. Allows the caller to start processing function bodies before
+ * the entire input is decompressed. Must be called before any input is
+ * passed to the decompressor. Returns true if successful.
+ */
+extern bool set_decompressor_function_callback(
+    void* D,
+    decompressor_function_callback Callback,
+    void* Data);
+
+/* Decompresses a single entry of the index of a compressed file (see the
+ * --index option of compress-int). Allows random access to each section,
+ * and each group of function bodies, of the compressed file. Compressed (of
+ * CompressedSize bytes) is the compressed file, and Index (of IndexSize
+ * bytes) is its index. Must be called on a newly created decompressor, and
+ * replaces calls to resume_decompression(). A section is decompressed to
+ * the section (including its code and size). A group of function bodies is
+ * decompressed to the sequence of function bodies (each including its size
+ * prefix). If non-negative, returns the number of output bytes available to
+ * fetch using fetch_decompressor_output(). Otherwise returns
+ * DECOMPRESSOR_ERROR.
+ */
+extern int32_t decompress_indexed_entry(void* D,
+                                        const uint8_t* Compressed,
+                                        int32_t CompressedSize,
+                                        const uint8_t* Index,
+                                        int32_t IndexSize,
+                                        int32_t Entry);
+
+/* Returns the number of entries in Index (of IndexSize bytes), or
+ * DECOMPRESSOR_ERROR if malformed.
+ */
+extern int32_t get_decompressor_index_size(const uint8_t* Index,
+                                           int32_t IndexSize);
+
+/* Returns the entry of Index (of IndexSize bytes) containing the function
+ * body with index Function, or DECOMPRESSOR_ERROR if not found.
+ */
+extern int32_t find_decompressor_function_entry(const uint8_t* Index,
+                                                int32_t IndexSize,
+                                                int32_t Function);
+
 /* Fetch the next Size output bytes and put into the decompression buffer.
  * Returns true if successful.
  */
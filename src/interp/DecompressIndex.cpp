@@ -0,0 +1,215 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements the index of a compressed (integer) file.
+
+#include "interp/DecompressIndex.h"
+
+namespace wasm {
+
+using namespace decode;
+
+namespace interp {
+
+namespace {
+
+const char* getName(DecompressIndex::EntryKind Kind) {
+  switch (Kind) {
+    case DecompressIndex::EntryKind::Section:
+      return "section";
+    case DecompressIndex::EntryKind::Functions:
+      return "functions";
+  }
+  WASM_RETURN_UNREACHABLE("?");
+}
+
+void writeUint32(std::vector<uint8_t>& Bytes, uint32_t Value) {
+  for (int i = 0; i < 4; ++i) {
+    Bytes.push_back(uint8_t(Value));
+    Value >>= 8;
+  }
+}
+
+void writeVaruint32(std::vector<uint8_t>& Bytes, uint64_t Value) {
+  do {
+    uint8_t Byte = Value & 0x7f;
+    Value >>= 7;
+    if (Value)
+      Byte |= 0x80;
+    Bytes.push_back(Byte);
+  } while (Value);
+}
+
+// Reads values from a (bounded) buffer. Once a read fails, all subsequent
+// reads fail.
+class IndexReader {
+ public:
+  IndexReader(const uint8_t* Bytes, size_t Size)
+      : Cur(Bytes), End(Bytes + Size), IsGood(true) {}
+  bool isGood() const { return IsGood; }
+  bool atEnd() const { return Cur == End; }
+
+  uint32_t readUint32() {
+    uint32_t Value = 0;
+    for (int i = 0; i < 4; ++i)
+      Value |= uint32_t(readByte()) << (i * 8);
+    return Value;
+  }
+
+  uint32_t readVaruint32() {
+    uint32_t Value = 0;
+    for (unsigned Shift = 0; Shift < 35; Shift += 7) {
+      uint8_t Byte = readByte();
+      Value |= uint32_t(Byte & 0x7f) << Shift;
+      if ((Byte & 0x80) == 0)
+        return Value;
+    }
+    IsGood = false;
+    return 0;
+  }
+
+ private:
+  const uint8_t* Cur;
+  const uint8_t* End;
+  bool IsGood;
+
+  uint8_t readByte() {
+    if (Cur == End) {
+      IsGood = false;
+      return 0;
+    }
+    return *Cur++;
+  }
+};
+
+}  // end of anonymous namespace
+
+constexpr uint32_t DecompressIndex::Magic;
+constexpr uint32_t DecompressIndex::Version;
+
+DecompressIndex::Entry::Entry()
+    : Kind(EntryKind::Section),
+      Begin(0),
+      End(0),
+      ContentBegin(0),
+      Section(0),
+      FirstFunction(0),
+      NumFunctions(0) {}
+
+DecompressIndex::DecompressIndex() : BodyBegin(0) {}
+
+DecompressIndex::~DecompressIndex() {}
+
+size_t DecompressIndex::addSection(AddressType Begin,
+                                   AddressType ContentBegin,
+                                   AddressType End) {
+  Entry Sec;
+  Sec.Kind = EntryKind::Section;
+  Sec.Begin = Begin;
+  Sec.End = End;
+  Sec.ContentBegin = ContentBegin;
+  Entries.push_back(Sec);
+  return Entries.size() - 1;
+}
+
+size_t DecompressIndex::addFunctions(size_t Section,
+                                     size_t FirstFunction,
+                                     size_t NumFunctions,
+                                     AddressType Begin,
+                                     AddressType End) {
+  Entry Fcns;
+  Fcns.Kind = EntryKind::Functions;
+  Fcns.Begin = Begin;
+  Fcns.End = End;
+  Fcns.Section = Section;
+  Fcns.FirstFunction = FirstFunction;
+  Fcns.NumFunctions = NumFunctions;
+  Entries.push_back(Fcns);
+  return Entries.size() - 1;
+}
+
+void DecompressIndex::write(std::vector<uint8_t>& Bytes) const {
+  writeUint32(Bytes, Magic);
+  writeUint32(Bytes, Version);
+  writeVaruint32(Bytes, BodyBegin);
+  writeVaruint32(Bytes, Entries.size());
+  for (const Entry& E : Entries) {
+    writeVaruint32(Bytes, uint32_t(E.Kind));
+    writeVaruint32(Bytes, E.Begin);
+    writeVaruint32(Bytes, E.End);
+    writeVaruint32(Bytes, E.ContentBegin);
+    writeVaruint32(Bytes, E.Section);
+    writeVaruint32(Bytes, E.FirstFunction);
+    writeVaruint32(Bytes, E.NumFunctions);
+  }
+}
+
+bool DecompressIndex::read(const uint8_t* Bytes, size_t Size) {
+  Entries.clear();
+  IndexReader Reader(Bytes, Size);
+  if (Reader.readUint32() != Magic || Reader.readUint32() != Version)
+    return false;
+  BodyBegin = Reader.readVaruint32();
+  size_t NumEntries = Reader.readVaruint32();
+  for (size_t i = 0; i < NumEntries && Reader.isGood(); ++i) {
+    Entry E;
+    uint32_t Kind = Reader.readVaruint32();
+    if (Kind > uint32_t(EntryKind::Functions))
+      return false;
+    E.Kind = EntryKind(Kind);
+    E.Begin = Reader.readVaruint32();
+    E.End = Reader.readVaruint32();
+    E.ContentBegin = Reader.readVaruint32();
+    E.Section = Reader.readVaruint32();
+    E.FirstFunction = Reader.readVaruint32();
+    E.NumFunctions = Reader.readVaruint32();
+    if (E.Begin > E.End)
+      return false;
+    switch (E.Kind) {
+      case EntryKind::Section:
+        if (E.ContentBegin < E.Begin || E.ContentBegin > E.End)
+          return false;
+        break;
+      case EntryKind::Functions:
+        if (E.Section >= Entries.size() ||
+            Entries[E.Section].Kind != EntryKind::Section)
+          return false;
+        break;
+    }
+    Entries.push_back(E);
+  }
+  return Reader.isGood() && Reader.atEnd();
+}
+
+void DecompressIndex::describe(FILE* File) const {
+  fprintf(File, "Index: body at %" PRIuMAX ", %" PRIuMAX " entries\n",
+          uintmax_t(BodyBegin), uintmax_t(Entries.size()));
+  for (size_t i = 0; i < Entries.size(); ++i) {
+    const Entry& E = Entries[i];
+    fprintf(File, "  %" PRIuMAX ": %s [%" PRIuMAX ", %" PRIuMAX ")",
+            uintmax_t(i), getName(E.Kind), uintmax_t(E.Begin),
+            uintmax_t(E.End));
+    if (E.Kind == EntryKind::Functions)
+      fprintf(File, " section %" PRIuMAX " functions %" PRIuMAX "..%" PRIuMAX,
+              uintmax_t(E.Section), uintmax_t(E.FirstFunction),
+              uintmax_t(E.FirstFunction + E.NumFunctions));
+    fputc('\n', File);
+  }
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
@@ -0,0 +1,119 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines the index of a compressed (integer) file, allowing a single
+// section, or a group of function bodies, to be decompressed without
+// decompressing what precedes it.
+//
+// Each entry of the index is a range of the compressed file. Since the
+// abbreviations of the compressed file are fixed (i.e. defined by the
+// algorithm at the beginning of the file), the state needed to resume
+// decompression of an entry is:
+//
+//   1) The beginning of the file, up to (and including) the header of the
+//      compressed data (i.e. the algorithm defining the abbreviations).
+//
+//   2) For groups of function bodies, the beginning of the enclosing
+//      section, up to its contents (i.e. the section code and size).
+//
+// Entries are only created at byte-aligned block boundaries of the
+// compressed data, so that ranges can be concatenated.
+//
+// The index is stored as:
+//
+//   uint32 magic ("widx")
+//   uint32 version
+//   varuint32 BodyBegin
+//   varuint32 NumEntries
+//   (varuint32 Kind varuint32 Begin varuint32 End
+//    varuint32 ContentBegin varuint32 Section
+//    varuint32 FirstFunction varuint32 NumFunctions) * NumEntries
+
+#ifndef DECOMPRESSOR_SRC_INTERP_DECOMPRESSINDEX_H_
+#define DECOMPRESSOR_SRC_INTERP_DECOMPRESSINDEX_H_
+
+#include <vector>
+
+#include "utils/Defs.h"
+
+namespace wasm {
+
+namespace interp {
+
+class DecompressIndex {
+  DecompressIndex(const DecompressIndex&) = delete;
+  DecompressIndex& operator=(const DecompressIndex&) = delete;
+
+ public:
+  static constexpr uint32_t Magic = 0x78646977;
+  static constexpr uint32_t Version = 0x0;
+
+  enum class EntryKind : uint32_t { Section = 0, Functions = 1 };
+
+  struct Entry {
+    EntryKind Kind;
+    // The range [Begin, End) of the entry in the compressed file.
+    decode::AddressType Begin;
+    decode::AddressType End;
+    // Sections only: Where the contents of the section begin.
+    decode::AddressType ContentBegin;
+    // Functions only: The index of the (entry of the) enclosing section.
+    size_t Section;
+    // Functions only: The index of the first function body in the section,
+    // and the number of function bodies in the group.
+    size_t FirstFunction;
+    size_t NumFunctions;
+    Entry();
+  };
+
+  DecompressIndex();
+  ~DecompressIndex();
+
+  // Where the compressed data (after its header) begins.
+  decode::AddressType getBodyBegin() const { return BodyBegin; }
+  void setBodyBegin(decode::AddressType NewValue) { BodyBegin = NewValue; }
+
+  size_t getNumEntries() const { return Entries.size(); }
+  const Entry& getEntry(size_t Index) const { return Entries[Index]; }
+
+  // Adds the corresponding entry. Returns its index.
+  size_t addSection(decode::AddressType Begin,
+                    decode::AddressType ContentBegin,
+                    decode::AddressType End);
+  size_t addFunctions(size_t Section,
+                      size_t FirstFunction,
+                      size_t NumFunctions,
+                      decode::AddressType Begin,
+                      decode::AddressType End);
+
+  void write(std::vector<uint8_t>& Bytes) const;
+
+  // Replaces the contents with the index stored in Bytes. Returns false
+  // if malformed.
+  bool read(const uint8_t* Bytes, size_t Size);
+
+  void describe(FILE* File) const;
+
+ private:
+  decode::AddressType BodyBegin;
+  std::vector<Entry> Entries;
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_DECOMPRESSINDEX_H_
@@ -27,10 +27,18 @@
 // used to parse the algorithm has the same value for the source and target
 // headers. All other algorithms are assumed to a data algorithm that completes
 // the decompression.
+//
+// When pipelined, the final algorithm runs on its own thread, with its own
+// interpreter. The generated intermediate stream is passed (in pages)
+// through an integer pipe, and replayed into an integer stream read by the
+// final algorithm. The pipe is bounded, so that the generating algorithm
+// can't get too far ahead of the final algorithm.
 
 #include "interp/DecompressSelector.h"
 
 #include "casm/InflateAst.h"
+#include "interp/IntPipe.h"
+#include "interp/IntPipeWriter.h"
 #include "interp/IntReader.h"
 #include "interp/IntWriter.h"
 #include "interp/Interpreter.h"
@@ -44,9 +52,55 @@ using namespace filt;
 namespace interp {
 
 DecompAlgState::DecompAlgState(Interpreter* MyInterpreter)
-    : MyInterpreter(MyInterpreter) {}
+    : MyInterpreter(MyInterpreter),
+      PipelineStages(false),
+      NativeDecode(nullptr),
+      FinalStageSucceeded(false) {}
+
+DecompAlgState::~DecompAlgState() {
+  if (!FinalStage.joinable())
+    return;
+  // Decompression stopped early. Wake up and stop the final algorithm.
+  Pipe->abort();
+  FinalStage.join();
+}
+
+void DecompAlgState::startFinalStage() {
+  Pipe = std::make_shared<IntPipe>();
+  FinalStageSucceeded = false;
+  FinalStage = std::thread(&DecompAlgState::runFinalStage, this, FinalSymtab,
+                           OrigWriter, std::cref(MyInterpreter->getFlags()),
+                           MyInterpreter->getFreezeEofAtExit());
+  FinalSymtab.reset();
+}
 
-DecompAlgState::~DecompAlgState() {}
+bool DecompAlgState::finishFinalStage() {
+  FinalStage.join();
+  Pipe.reset();
+  return FinalStageSucceeded;
+}
+
+void DecompAlgState::runFinalStage(std::shared_ptr<SymbolTable> Symtab,
+                                   std::shared_ptr<Writer> Output,
+                                   const InterpreterFlags& Flags,
+                                   bool FreezeEofAtExit) {
+  auto Stream = std::make_shared<IntStream>();
+  IntWriter StreamWriter(Stream);
+  Interpreter Final(std::make_shared<IntReader>(Stream), Output, Flags,
+                    Symtab);
+  Final.setFreezeEofAtExit(FreezeEofAtExit);
+  Final.algorithmStart();
+  IntPipe::Page Pg;
+  while (!Final.isFinished() && Pipe->read(Pg)) {
+    if (!IntPipe::replay(Pg, StreamWriter))
+      break;
+    Final.algorithmResume();
+  }
+  FinalStageSucceeded = Final.isFinished() && Final.isSuccessful();
+  // Note: If the final algorithm stopped early, this also stops the
+  // generating algorithm.
+  Pipe->abort();
+}
 
 DecompressSelector::DecompressSelector(
     std::shared_ptr<filt::SymbolTable> Symtab,
@@ -89,8 +143,18 @@ bool DecompressSelector::applyNextQueuedAlgorithm(Interpreter* R) {
     State->FinalSymtab =
         State->MyInterpreter->getDefaultAlgorithm(NextSymtab->getWriteHeader());
   State->OrigWriter = R->getWriter();
-  State->IntermediateStream = std::make_shared<IntStream>();
-  R->setWriter(std::make_shared<IntWriter>(State->IntermediateStream));
+  std::shared_ptr<Writer> IntOutput;
+  if (State->AlgQueue.empty() && State->PipelineStages &&
+      State->FinalSymtab) {
+    State->startFinalStage();
+    IntOutput = std::make_shared<IntPipeWriter>(State->Pipe);
+  } else {
+    State->IntermediateStream = std::make_shared<IntStream>();
+    IntOutput = std::make_shared<IntWriter>(State->IntermediateStream);
+  }
+  if (State->AlgQueue.empty() && State->WrapFinalIntWriter)
+    IntOutput = State->WrapFinalIntWriter(IntOutput);
+  R->setWriter(IntOutput);
   return true;
 }
 
@@ -126,6 +190,12 @@ bool DecompressSelector::resetAlgorithm(Interpreter* R) {
 }
 
 bool DecompressSelector::resetData(Interpreter* R) {
+  if (State->FinalStage.joinable()) {
+    // Final algorithm was pipelined, and hence no more algorithms to apply.
+    R->setWriter(State->OrigWriter);
+    State->OrigWriter.reset();
+    return State->finishFinalStage();
+  }
   if (!State->IntermediateStream)
     // No decompression applied, just did copy of input. so done!
     return true;
@@ -134,6 +204,14 @@ bool DecompressSelector::resetData(Interpreter* R) {
   State->OrigWriter.reset();
   auto Input = std::make_shared<IntReader>(State->IntermediateStream);
   State->IntermediateStream.reset();
+  if (State->NativeDecode != nullptr && State->FinalSymtab &&
+      State->FinalSymtab == State->NativeSymtab && R->getFreezeEofAtExit() &&
+      !R->getFlags().TraceProgress) {
+    // Note: Like a pipelined final algorithm, the reader is left on the
+    // original input, which has been fully read.
+    State->FinalSymtab.reset();
+    return State->NativeDecode(*Input, *R->getWriter());
+  }
   R->setInput(Input);
   if (!State->FinalSymtab)
     return false;
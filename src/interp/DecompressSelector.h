@@ -22,11 +22,17 @@
 // integer streams as the intermediate representation) in the order
 // they are queued.  The last algorithm is run using the original
 // writer.
+//
+// Optionally, the last algorithm can be pipelined. That is, run on a
+// separate thread that consumes the last intermediate stream (passed
+// through a bounded integer pipe) while it is being generated.
 
 #ifndef DECOMPRESSOR_SRC_INTERP_DECOMPRESSSELECTOR_H_
 #define DECOMPRESSOR_SRC_INTERP_DECOMPRESSSELECTOR_H_
 
+#include <functional>
 #include <queue>
+#include <thread>
 
 #include "interp/AlgorithmSelector.h"
 
@@ -41,8 +47,11 @@ class SymbolTable;
 namespace interp {
 
 class Interpreter;
+class IntPipe;
 class IntStream;
+class Reader;
 class Writer;
+struct InterpreterFlags;
 
 class DecompAlgState : public std::enable_shared_from_this<DecompAlgState> {
   DecompAlgState(const DecompAlgState&) = delete;
@@ -50,10 +59,40 @@ class DecompAlgState : public std::enable_shared_from_this<DecompAlgState> {
   friend class DecompressSelector;
 
  public:
+  // Returns the writer to use in place of the given writer.
+  typedef std::function<std::shared_ptr<Writer>(std::shared_ptr<Writer>)>
+      WrapWriterFcn;
+  // A generated (native) decoder of an algorithm (see cast2casm --decoder).
+  typedef bool (*NativeDecoder)(Reader& Input, Writer& Output);
+
   explicit DecompAlgState(Interpreter* MyInterpreter = nullptr);
   virtual ~DecompAlgState();
   void setInterpreter(Interpreter* NewValue) { MyInterpreter = NewValue; }
 
+  // Wraps the writer of the last intermediate (integer) stream, i.e. the
+  // stream converted to binary by the final algorithm. Allows the caller to
+  // edit the integer stream.
+  void setWrapFinalIntWriter(WrapWriterFcn NewValue) {
+    WrapFinalIntWriter = NewValue;
+  }
+
+  // When true, the final algorithm is run on a separate thread, concurrently
+  // with the algorithm generating the last intermediate stream. Only
+  // applicable if the interpreter reads all of its input (i.e. uses
+  // algorithmRead()), since the original writer is written by the other
+  // thread.
+  void setPipelineStages(bool NewValue) { PipelineStages = NewValue; }
+  bool getPipelineStages() const { return PipelineStages; }
+
+  // Converts the last intermediate stream using Decoder, rather than
+  // interpreting the final algorithm, when the final algorithm is
+  // AlgSymtab. Not used when pipelined or tracing.
+  void setNativeDecoder(std::shared_ptr<filt::SymbolTable> AlgSymtab,
+                        NativeDecoder Decoder) {
+    NativeSymtab = AlgSymtab;
+    NativeDecode = Decoder;
+  }
+
  private:
   Interpreter* MyInterpreter;
   std::queue<std::shared_ptr<filt::SymbolTable>> AlgQueue;
@@ -61,6 +100,25 @@ class DecompAlgState : public std::enable_shared_from_this<DecompAlgState> {
   std::shared_ptr<filt::InflateAst> Inflator;
   std::shared_ptr<Writer> OrigWriter;
   std::shared_ptr<IntStream> IntermediateStream;
+  WrapWriterFcn WrapFinalIntWriter;
+  bool PipelineStages;
+  std::shared_ptr<filt::SymbolTable> NativeSymtab;
+  NativeDecoder NativeDecode;
+  // The following fields are only defined while the final algorithm is
+  // pipelined.
+  std::shared_ptr<IntPipe> Pipe;
+  std::thread FinalStage;
+  bool FinalStageSucceeded;
+
+  // Starts the final algorithm on a separate thread, reading Pipe and writing
+  // the original writer.
+  void startFinalStage();
+  // Waits for the final algorithm to complete. Returns true if successful.
+  bool finishFinalStage();
+  void runFinalStage(std::shared_ptr<filt::SymbolTable> Symtab,
+                     std::shared_ptr<Writer> Output,
+                     const InterpreterFlags& Flags,
+                     bool FreezeEofAtExit);
 };
 
 class DecompressSelector : public AlgorithmSelector {
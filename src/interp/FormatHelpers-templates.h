@@ -21,6 +21,8 @@
 
 #include "interp/FormatHelpers.h"
 
+#include <type_traits>
+
 namespace wasm {
 
 namespace interp {
@@ -39,9 +41,55 @@ Type readFixed(ReadCursor& Pos) {
   return Value;
 }
 
+// Decodes the LEB128 value at the beginning of Buffer, which must contain at
+// least sizeof(uint64_t) bytes. Rather than looping over each byte, the
+// bytes are loaded as a single (little-endian) word. The terminating byte is
+// found by masking the continuation bits, and the 7-bit chunks are then
+// compacted in parallel. Returns the number of bytes decoded, or zero if the
+// value doesn't terminate within the word (or is too long for Type).
+template <class Type>
+uint32_t decodeLEB128Word(const uint8_t* Buffer, Type& Value, uint8_t& Chunk) {
+  constexpr uint32_t WordSize = sizeof(uint64_t);
+  constexpr uint32_t MaxBytes = (sizeof(Type) * CHAR_BIT + 6) / 7;
+  uint64_t Word = 0;
+  for (uint32_t i = 0; i < WordSize; ++i)
+    Word |= uint64_t(Buffer[i]) << (i * CHAR_BIT);
+  uint64_t Stops = ~Word & UINT64_C(0x8080808080808080);
+  if (Stops == 0)
+    return 0;
+  // Mask out the bytes following the first (i.e. terminating) stop bit.
+  uint64_t StopBit = Stops & (~Stops + 1);
+  uint64_t Mask = StopBit ^ (StopBit - 1);
+  // Count the bytes in Mask, by summing a bit per byte into the top byte.
+  uint32_t NumBytes = uint32_t(
+      (((Mask >> 7) & UINT64_C(0x0101010101010101)) *
+       UINT64_C(0x0101010101010101)) >>
+      ((WordSize - 1) * CHAR_BIT));
+  if (NumBytes > MaxBytes)
+    return 0;
+  Chunk = uint8_t(Word >> ((NumBytes - 1) * CHAR_BIT));
+  Word &= Mask & UINT64_C(0x7f7f7f7f7f7f7f7f);
+  Word = ((Word & UINT64_C(0x7f007f007f007f00)) >> 1) |
+         (Word & UINT64_C(0x007f007f007f007f));
+  Word = ((Word & UINT64_C(0x3fff00003fff0000)) >> 2) |
+         (Word & UINT64_C(0x00003fff00003fff));
+  Word = ((Word & UINT64_C(0x0fffffff00000000)) >> 4) |
+         (Word & UINT64_C(0x000000000fffffff));
+  Value = Type(Word);
+  return NumBytes;
+}
+
 template <class Type, class ReadCursor>
 Type readLEB128Loop(ReadCursor& Pos, uint32_t& Shift, uint8_t& Chunk) {
   Type Value = 0;
+  if (Pos.getContiguousBytesAvailable() >= sizeof(uint64_t)) {
+    uint32_t NumBytes = decodeLEB128Word(Pos.getBufferPtr(), Value, Chunk);
+    if (NumBytes > 0) {
+      Pos.consumeContiguousBytes(NumBytes);
+      Shift = NumBytes * 7;
+      return Value;
+    }
+  }
   Shift = 0;
   while (true) {
     Chunk = Pos.readByte();
@@ -105,6 +153,81 @@ uint64_t readVaruint64(ReadCursor& Pos) {
   return fmt::readLEB128<uint64_t>(Pos);
 }
 
+template <class ReadCursor>
+void readVaruint32Array(ReadCursor& Pos, uint32_t* Values, size_t Count) {
+  while (Count > 0) {
+    // Decode directly from the page buffer, while there is enough room.
+    size_t Available = Pos.getContiguousBytesAvailable();
+    if (Available >= sizeof(uint64_t)) {
+      const uint8_t* Buffer = Pos.getBufferPtr();
+      size_t Used = 0;
+      uint8_t Chunk;
+      while (Count > 0 && Available - Used >= sizeof(uint64_t)) {
+        uint32_t NumBytes = decodeLEB128Word(Buffer + Used, *Values, Chunk);
+        if (NumBytes == 0)
+          break;
+        Used += NumBytes;
+        ++Values;
+        --Count;
+      }
+      Pos.consumeContiguousBytes(Used);
+      if (Count == 0)
+        return;
+    }
+    // Handles page/block boundaries (and malformed values).
+    *Values++ = readVaruint32(Pos);
+    --Count;
+  }
+}
+
+template <class Type>
+uint32_t getLEB128Size(Type Value) {
+  uint32_t NumBytes = 1;
+  while (Value >>= 7)
+    ++NumBytes;
+  return NumBytes;
+}
+
+template <class Type>
+uint32_t getPositiveLEB128Size(Type Value) {
+  // Note: The (zero) sign bit must also fit in the last chunk.
+  typedef typename std::make_unsigned<Type>::type UnsignedType;
+  return getLEB128Size(UnsignedType(UnsignedType(Value) << 1));
+}
+
+template <class Type>
+uint32_t getNegativeLEB128Size(Type Value) {
+  return getPositiveLEB128Size(Type(~Value));
+}
+
+template <class Type>
+uint32_t getFixedLEB128Size() {
+  constexpr uint32_t BitsInWord = sizeof(Type) * CHAR_BIT;
+  constexpr uint32_t ChunkSize = CHAR_BIT - 1;
+  return (BitsInWord + ChunkSize - 1) / ChunkSize;
+}
+
+// Encodes the NumBytes (7-bit) chunks of Value into Buffer.
+template <class Type>
+void encodeLEB128(Type Value, uint8_t* Buffer, uint32_t NumBytes) {
+  for (uint32_t i = 1; i < NumBytes; ++i) {
+    *Buffer++ = uint8_t(Value & 0x7f) | 0x80;
+    Value >>= 7;
+  }
+  *Buffer = uint8_t(Value & 0x7f);
+}
+
+// Writes Value (as NumBytes chunks) directly into the page buffer if there is
+// room. Returns false if not written.
+template <class Type, class WriteCursor>
+bool writeContiguousLEB128(Type Value, WriteCursor& Pos, uint32_t NumBytes) {
+  if (Pos.getContiguousBytesAvailable() < NumBytes)
+    return false;
+  encodeLEB128(Value, Pos.getBufferPtr(), NumBytes);
+  Pos.consumeContiguousBytes(NumBytes);
+  return true;
+}
+
 #ifdef LEB128_LOOP_UNTIL
 #error("LEB128_LOOP_UNTIL already defined!")
 #endif
@@ -123,24 +246,30 @@ uint64_t readVaruint64(ReadCursor& Pos) {
 
 template <class Type, class WriteCursor>
 void writeLEB128(Type Value, WriteCursor& Pos) {
+  if (writeContiguousLEB128(Value, Pos, getLEB128Size(Value)))
+    return;
   LEB128_LOOP_UNTIL(Value == 0);
 }
 
 template <class Type, class WriteCursor>
 void writePositiveLEB128(Type Value, WriteCursor& Pos) {
+  if (writeContiguousLEB128(Value, Pos, getPositiveLEB128Size(Value)))
+    return;
   LEB128_LOOP_UNTIL(Value == 0 && !(Byte & 0x40));
 }
 
 template <class Type, class WriteCursor>
 void writeNegativeLEB128(Type Value, WriteCursor& Pos) {
+  if (writeContiguousLEB128(Value, Pos, getNegativeLEB128Size(Value)))
+    return;
   LEB128_LOOP_UNTIL(Value == -1 && (Byte & 0x40));
 }
 
 template <class Type, class WriteCursor>
 void writeFixedLEB128(Type Value, WriteCursor& Pos) {
-  constexpr uint32_t BitsInWord = sizeof(Type) * CHAR_BIT;
-  constexpr uint32_t ChunkSize = CHAR_BIT - 1;
-  constexpr uint32_t ChunksInWord = (BitsInWord + ChunkSize - 1) / ChunkSize;
+  const uint32_t ChunksInWord = getFixedLEB128Size<Type>();
+  if (writeContiguousLEB128(Value, Pos, ChunksInWord))
+    return;
   uint32_t Count = 0;
   LEB128_LOOP_UNTIL(++Count == ChunksInWord);
 }
@@ -201,6 +330,33 @@ void writeFixedVaruint32(uint32_t Value, WriteCursor& Pos) {
   writeFixedLEB128(Value, Pos);
 }
 
+template <class WriteCursor>
+void writeVaruint32Array(const uint32_t* Values,
+                         size_t Count,
+                         WriteCursor& Pos) {
+  const uint32_t MaxBytes = getFixedLEB128Size<uint32_t>();
+  while (Count > 0) {
+    // Encode directly into the page buffer, while there is enough room.
+    size_t Available = Pos.getContiguousBytesAvailable();
+    if (Available >= MaxBytes) {
+      uint8_t* Buffer = Pos.getBufferPtr();
+      size_t Used = 0;
+      for (; Count > 0 && Available - Used >= MaxBytes; --Count) {
+        uint32_t Value = *Values++;
+        uint32_t NumBytes = getLEB128Size(Value);
+        encodeLEB128(Value, Buffer + Used, NumBytes);
+        Used += NumBytes;
+      }
+      Pos.consumeContiguousBytes(Used);
+      if (Count == 0)
+        return;
+    }
+    // Handles page/block boundaries.
+    writeVaruint32(*Values++, Pos);
+    --Count;
+  }
+}
+
 }  // end of namespace fmt
 
 }  // end of namespace decode
@@ -60,6 +60,9 @@ uint32_t readVaruint32(ReadCursor& Pos);
 template <class ReadCursor>
 uint64_t readVaruint64(ReadCursor& Pos);
 
+template <class ReadCursor>
+void readVaruint32Array(ReadCursor& Pos, uint32_t* Values, size_t Count);
+
 template <class Type, class WriteCursor>
 void writeLEB128(Type Value, WriteCursor& Pos);
 
@@ -99,6 +102,21 @@ void writeVaruint64(uint64_t Value, WriteCursor& Pos);
 template <class WriteCursor>
 void writeFixedVaruint32(uint32_t Value, WriteCursor& Pos);
 
+template <class WriteCursor>
+void writeVaruint32Array(const uint32_t* Values,
+                         size_t Count,
+                         WriteCursor& Pos);
+
+// Returns the number of bytes needed to (LEB128) encode Value.
+template <class Type>
+uint32_t getLEB128Size(Type Value);
+
+template <class Type>
+uint32_t getPositiveLEB128Size(Type Value);
+
+template <class Type>
+uint32_t getNegativeLEB128Size(Type Value);
+
 }  // end of namespace fmt
 
 }  // end of namespace decode
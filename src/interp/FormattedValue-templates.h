@@ -0,0 +1,105 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines templates that read/write a value using the format defined by an
+// AST node. By instantiating with a concrete (final) reader/writer class, the
+// calls to the read/write method of each format are resolved at compile time.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_FORMATTEDVALUE_TEMPLATES_H_
+#define DECOMPRESSOR_SRC_INTERP_FORMATTEDVALUE_TEMPLATES_H_
+
+#include "sexp/Ast.h"
+
+namespace wasm {
+
+namespace interp {
+
+template <class ReaderType>
+bool readFormattedValue(ReaderType& Input,
+                        const filt::Node* Format,
+                        decode::IntType& Value) {
+  switch (Format->getType()) {
+    case filt::NodeType::Bit:
+      Value = Input.readBit();
+      return true;
+    case filt::NodeType::Uint8:
+      Value = Input.readUint8();
+      return true;
+    case filt::NodeType::Uint32:
+      Value = Input.readUint32();
+      return true;
+    case filt::NodeType::Uint64:
+      Value = Input.readUint64();
+      return true;
+    case filt::NodeType::Varint32:
+      Value = Input.readVarint32();
+      return true;
+    case filt::NodeType::Varint64:
+      Value = Input.readVarint64();
+      return true;
+    case filt::NodeType::Varuint32:
+      Value = Input.readVaruint32();
+      return true;
+    case filt::NodeType::Varuint64:
+      Value = Input.readVaruint64();
+      return true;
+    default:
+      Value = 0;
+      return false;
+  }
+}
+
+// Note: Writes are passed through the typed write methods to force any
+// applicable cast conversions.
+template <class WriterType>
+bool writeFormattedValue(WriterType& Output,
+                         decode::IntType Value,
+                         const filt::Node* Format) {
+  switch (Format->getType()) {
+    case filt::NodeType::Bit:
+      Output.writeBit(Value);
+      return true;
+    case filt::NodeType::Uint8:
+      Output.writeUint8(Value);
+      return true;
+    case filt::NodeType::Uint32:
+      Output.writeUint32(Value);
+      return true;
+    case filt::NodeType::Uint64:
+      Output.writeUint64(Value);
+      return true;
+    case filt::NodeType::Varint32:
+      Output.writeVarint32(Value);
+      return true;
+    case filt::NodeType::Varint64:
+      Output.writeVarint64(Value);
+      return true;
+    case filt::NodeType::Varuint32:
+      Output.writeVaruint32(Value);
+      return true;
+    case filt::NodeType::Varuint64:
+      Output.writeVaruint64(Value);
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_FORMATTEDVALUE_TEMPLATES_H_
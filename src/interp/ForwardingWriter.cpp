@@ -0,0 +1,163 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a writer that forwards all write actions to another writer.
+
+#include "interp/ForwardingWriter.h"
+
+#include "stream/WriteCursor.h"
+
+namespace wasm {
+
+using namespace decode;
+using namespace utils;
+
+namespace interp {
+
+ForwardingWriter::ForwardingWriter(std::shared_ptr<Writer> Output)
+    : Writer(true), Output(Output) {}
+
+ForwardingWriter::~ForwardingWriter() {}
+
+AddressType ForwardingWriter::getAddress() {
+  WriteCursor* Pos = Output->getBytePos();
+  return Pos ? Pos->getAddress() : 0;
+}
+
+void ForwardingWriter::reset() {
+  Output->reset();
+}
+
+StreamType ForwardingWriter::getStreamType() const {
+  return Output->getStreamType();
+}
+
+WriteCursor* ForwardingWriter::getBytePos() {
+  return Output->getBytePos();
+}
+
+bool ForwardingWriter::writeBit(uint8_t Value) {
+  return Output->writeBit(Value);
+}
+
+bool ForwardingWriter::writeBits(uint32_t Value, unsigned Count) {
+  return Output->writeBits(Value, Count);
+}
+
+bool ForwardingWriter::writeUint8(uint8_t Value) {
+  return Output->writeUint8(Value);
+}
+
+bool ForwardingWriter::writeUint32(uint32_t Value) {
+  return Output->writeUint32(Value);
+}
+
+bool ForwardingWriter::writeUint64(uint64_t Value) {
+  return Output->writeUint64(Value);
+}
+
+bool ForwardingWriter::writeVarint32(int32_t Value) {
+  return Output->writeVarint32(Value);
+}
+
+bool ForwardingWriter::writeVarint64(int64_t Value) {
+  return Output->writeVarint64(Value);
+}
+
+bool ForwardingWriter::writeVaruint32(uint32_t Value) {
+  return Output->writeVaruint32(Value);
+}
+
+bool ForwardingWriter::writeVaruint64(uint64_t Value) {
+  return Output->writeVaruint64(Value);
+}
+
+bool ForwardingWriter::writeUint8Array(const uint8_t* Values, size_t Count) {
+  return Output->writeUint8Array(Values, Count);
+}
+
+bool ForwardingWriter::writeVaruint32Array(const uint32_t* Values,
+                                           size_t Count) {
+  return Output->writeVaruint32Array(Values, Count);
+}
+
+bool ForwardingWriter::alignToByte() {
+  return Output->alignToByte();
+}
+
+bool ForwardingWriter::writeBlockEnter() {
+  return Output->writeBlockEnter();
+}
+
+bool ForwardingWriter::writeBlockExit() {
+  return Output->writeBlockExit();
+}
+
+bool ForwardingWriter::writeFreezeEof() {
+  return Output->writeFreezeEof();
+}
+
+bool ForwardingWriter::writeBinary(IntType Value, const filt::Node* Encoding) {
+  return Output->writeBinary(Value, Encoding);
+}
+
+bool ForwardingWriter::writeValue(IntType Value, const filt::Node* Format) {
+  return Output->writeValue(Value, Format);
+}
+
+bool ForwardingWriter::writeTypedValue(IntType Value, IntTypeFormat Format) {
+  return Output->writeTypedValue(Value, Format);
+}
+
+bool ForwardingWriter::writeHeaderValue(IntType Value, IntTypeFormat Format) {
+  return Output->writeHeaderValue(Value, Format);
+}
+
+bool ForwardingWriter::writeHeaderClose() {
+  return Output->writeHeaderClose();
+}
+
+bool ForwardingWriter::writeAction(IntType Action) {
+  return Output->writeAction(Action);
+}
+
+bool ForwardingWriter::tablePush(IntType Value) {
+  return Output->tablePush(Value);
+}
+
+bool ForwardingWriter::tablePop() {
+  return Output->tablePop();
+}
+
+void ForwardingWriter::setMinimizeBlockSize(bool NewValue) {
+  Output->setMinimizeBlockSize(NewValue);
+}
+
+void ForwardingWriter::describeState(FILE* File) {
+  Output->describeState(File);
+}
+
+TraceContextPtr ForwardingWriter::getTraceContext() {
+  return Output->getTraceContext();
+}
+
+void ForwardingWriter::setTrace(std::shared_ptr<TraceClass> NewTrace) {
+  Output->setTrace(NewTrace);
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
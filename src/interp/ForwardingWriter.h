@@ -0,0 +1,87 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a writer that forwards all write actions to another writer. Used
+// as the base class of writers that need to observe (or edit) the actions
+// being written to a writer.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_FORWARDINGWRITER_H_
+#define DECOMPRESSOR_SRC_INTERP_FORWARDINGWRITER_H_
+
+#include "interp/Writer.h"
+
+namespace wasm {
+
+namespace interp {
+
+class ForwardingWriter : public Writer {
+  ForwardingWriter() = delete;
+  ForwardingWriter(const ForwardingWriter&) = delete;
+  ForwardingWriter& operator=(const ForwardingWriter&) = delete;
+
+ public:
+  explicit ForwardingWriter(std::shared_ptr<Writer> Output);
+  ~ForwardingWriter() OVERRIDE;
+
+  std::shared_ptr<Writer> getOutput() { return Output; }
+
+  void reset() OVERRIDE;
+  decode::StreamType getStreamType() const OVERRIDE;
+  decode::WriteCursor* getBytePos() OVERRIDE;
+  bool writeBit(uint8_t Value) OVERRIDE;
+  bool writeBits(uint32_t Value, unsigned Count) OVERRIDE;
+  bool writeUint8(uint8_t Value) OVERRIDE;
+  bool writeUint32(uint32_t Value) OVERRIDE;
+  bool writeUint64(uint64_t Value) OVERRIDE;
+  bool writeVarint32(int32_t Value) OVERRIDE;
+  bool writeVarint64(int64_t Value) OVERRIDE;
+  bool writeVaruint32(uint32_t Value) OVERRIDE;
+  bool writeVaruint64(uint64_t Value) OVERRIDE;
+  bool writeUint8Array(const uint8_t* Values, size_t Count) OVERRIDE;
+  bool writeVaruint32Array(const uint32_t* Values, size_t Count) OVERRIDE;
+  bool alignToByte() OVERRIDE;
+  bool writeBlockEnter() OVERRIDE;
+  bool writeBlockExit() OVERRIDE;
+  bool writeFreezeEof() OVERRIDE;
+  bool writeBinary(decode::IntType Value, const filt::Node* Encoding) OVERRIDE;
+  bool writeValue(decode::IntType Value, const filt::Node* Format) OVERRIDE;
+  bool writeTypedValue(decode::IntType Value,
+                       interp::IntTypeFormat Format) OVERRIDE;
+  bool writeHeaderValue(decode::IntType Value,
+                        interp::IntTypeFormat Format) OVERRIDE;
+  bool writeHeaderClose() OVERRIDE;
+  bool writeAction(decode::IntType Action) OVERRIDE;
+  bool tablePush(decode::IntType Value) OVERRIDE;
+  bool tablePop() OVERRIDE;
+
+  void setMinimizeBlockSize(bool NewValue) OVERRIDE;
+  void describeState(FILE* File) OVERRIDE;
+
+  utils::TraceContextPtr getTraceContext() OVERRIDE;
+  void setTrace(std::shared_ptr<utils::TraceClass> Trace) OVERRIDE;
+
+ protected:
+  std::shared_ptr<Writer> Output;
+
+  // Returns the (byte) address of the output, if applicable.
+  decode::AddressType getAddress();
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_FORWARDINGWRITER_H_
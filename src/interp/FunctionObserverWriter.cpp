@@ -0,0 +1,132 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a writer that notifies an observer as soon as each function
+// body has been written.
+
+#include "interp/FunctionObserverWriter.h"
+
+#include "interp/Interpreter.h"
+#include "sexp/Ast.h"
+#include "stream/ReadCursor.h"
+#include "stream/WriteCursor.h"
+#include "utils/Casting.h"
+
+namespace wasm {
+
+using namespace decode;
+using namespace filt;
+using namespace utils;
+
+namespace interp {
+
+namespace {
+
+constexpr IntType NoAction = IntType(PredefinedSymbol::Unknown);
+
+}  // end of anonymous namespace
+
+FunctionObserverWriter::FunctionObserverWriter(std::shared_ptr<Writer> Output,
+                                               ObserverFcn Observer)
+    : ForwardingWriter(Output),
+      Observer(Observer),
+      MyInterpreter(nullptr),
+      ActionSymtab(nullptr),
+      BeginAction(NoAction),
+      EndAction(NoAction),
+      BeginAddress(0),
+      NumFunctions(0) {}
+
+FunctionObserverWriter::~FunctionObserverWriter() {}
+
+void FunctionObserverWriter::updateActions() {
+  // Note: The symbol table changes each time the interpreter selects a new
+  // algorithm. Hence, look up the actions each time it changes.
+  std::shared_ptr<SymbolTable> Symtab;
+  if (MyInterpreter)
+    Symtab = MyInterpreter->getSymbolTable();
+  if (Symtab.get() == ActionSymtab)
+    return;
+  ActionSymtab = Symtab.get();
+  BeginAction = NoAction;
+  EndAction = NoAction;
+  if (!Symtab)
+    return;
+  SymbolTable::ActionDefSet Defs;
+  Symtab->collectActionDefs(Defs);
+  for (const LiteralActionDef* Def : Defs) {
+    const auto* Sym = dyn_cast<Symbol>(Def->getKid(0));
+    const auto* IntNd = dyn_cast<IntegerNode>(Def->getKid(1));
+    if (Sym == nullptr || IntNd == nullptr)
+      continue;
+    if (Sym->getName() == "function.body.begin")
+      BeginAction = IntNd->getValue();
+    else if (Sym->getName() == "function.body.end")
+      EndAction = IntNd->getValue();
+  }
+}
+
+void FunctionObserverWriter::reset() {
+  Output->reset();
+  ActionSymtab = nullptr;
+  BeginAddress = 0;
+  BeginPos.reset();
+  NumFunctions = 0;
+}
+
+const uint8_t* FunctionObserverWriter::readBody(AddressType EndAddress) {
+  if (!BeginPos)
+    return nullptr;
+  Body.resize(EndAddress - BeginAddress);
+  uint8_t* Bytes = Body.data();
+  size_t Size = Body.size();
+  while (Size > 0) {
+    size_t Count = std::min(Size, BeginPos->getContiguousBytesAvailable());
+    if (Count == 0) {
+      // At a page boundary, let the cursor advance to the next page.
+      *Bytes++ = BeginPos->readByte();
+      --Size;
+      continue;
+    }
+    memcpy(Bytes, BeginPos->getBufferPtr(), Count);
+    BeginPos->consumeContiguousBytes(Count);
+    Bytes += Count;
+    Size -= Count;
+  }
+  BeginPos.reset();
+  return Body.data();
+}
+
+bool FunctionObserverWriter::writeAction(IntType Action) {
+  if (!Output->writeAction(Action))
+    return false;
+  if (Action < NumPredefinedSymbols)
+    return true;
+  updateActions();
+  if (Action == BeginAction) {
+    BeginAddress = getAddress();
+    WriteCursor* Pos = Output->getBytePos();
+    BeginPos.reset(Pos ? new ReadCursor(*Pos, BeginAddress) : nullptr);
+  } else if (Action == EndAction) {
+    AddressType EndAddress = getAddress();
+    Observer(NumFunctions++, BeginAddress, EndAddress, readBody(EndAddress));
+  }
+  return true;
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
@@ -0,0 +1,104 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a writer that forwards all write actions to another writer, and
+// notifies an observer as soon as each function body has been written.
+//
+// Function bodies are recognized by the 'function.body.begin' and
+// 'function.body.end' callback actions of the algorithm being applied by
+// the interpreter. The observer is given the (byte) address range of the
+// function body (including its size prefix) in the output, and a copy of its
+// bytes.
+//
+// Note: The output isn't necessarily available (to the consumer of the output
+// queue) when the observer is called, since the enclosing code section keeps
+// its pages in the queue until the section size is backpatched. Hence, the
+// function body is read (while its pages are pinned) and passed to the
+// observer.
+//
+// Note: When block sizes are minimized, the function body may later be
+// moved (when the size of the enclosing code section is backpatched), but
+// its contents will not change. When block sizes are precomputed, the range
+// is not meaningful.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_FUNCTIONOBSERVERWRITER_H_
+#define DECOMPRESSOR_SRC_INTERP_FUNCTIONOBSERVERWRITER_H_
+
+#include <functional>
+#include <vector>
+
+#include "interp/ForwardingWriter.h"
+
+namespace wasm {
+
+namespace decode {
+class ReadCursor;
+}  // end of namespace decode
+
+namespace interp {
+
+class Interpreter;
+
+class FunctionObserverWriter : public ForwardingWriter {
+  FunctionObserverWriter() = delete;
+  FunctionObserverWriter(const FunctionObserverWriter&) = delete;
+  FunctionObserverWriter& operator=(const FunctionObserverWriter&) = delete;
+
+ public:
+  // Called with the index of the function, the address range [Begin, End) of
+  // the function body in the output, and the (End - Begin) bytes of the
+  // function body. Bytes is only valid during the call, and is nullptr if
+  // the output isn't a byte stream.
+  typedef std::function<void(size_t Index,
+                             decode::AddressType Begin,
+                             decode::AddressType End,
+                             const uint8_t* Bytes)>
+      ObserverFcn;
+
+  FunctionObserverWriter(std::shared_ptr<Writer> Output, ObserverFcn Observer);
+  ~FunctionObserverWriter() OVERRIDE;
+
+  // Defines the interpreter whose symbol table defines the function body
+  // actions.
+  void setInterpreter(Interpreter* NewValue) { MyInterpreter = NewValue; }
+  size_t getNumFunctions() const { return NumFunctions; }
+
+  void reset() OVERRIDE;
+  bool writeAction(decode::IntType Action) OVERRIDE;
+
+ private:
+  ObserverFcn Observer;
+  Interpreter* MyInterpreter;
+  // Symbol table the begin/end actions were looked up in.
+  const void* ActionSymtab;
+  decode::IntType BeginAction;
+  decode::IntType EndAction;
+  decode::AddressType BeginAddress;
+  // Pins the output pages of the current function body, so that its bytes
+  // can be read when the function body ends.
+  std::unique_ptr<decode::ReadCursor> BeginPos;
+  std::vector<uint8_t> Body;
+  size_t NumFunctions;
+
+  void updateActions();
+  const uint8_t* readBody(decode::AddressType EndAddress);
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_FUNCTIONOBSERVERWRITER_H_
@@ -0,0 +1,142 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a writer that builds the index of the written (compressed)
+// file.
+
+#include "interp/IndexWriter.h"
+
+#include <functional>
+
+#include "sexp/Ast.h"
+
+namespace wasm {
+
+using namespace decode;
+using namespace filt;
+
+namespace interp {
+
+IndexWriter::IndexWriter(std::shared_ptr<Writer> Output,
+                         std::shared_ptr<DecompressIndex> Index,
+                         size_t FunctionInterval)
+    : ForwardingWriter(Output),
+      Index(Index),
+      FunctionInterval(FunctionInterval),
+      Depth(0),
+      SectionBegin(0),
+      ContentBegin(0),
+      NumFunctions(0) {}
+
+IndexWriter::~IndexWriter() {}
+
+void IndexWriter::reset() {
+  Output->reset();
+  Depth = 0;
+  Groups.clear();
+}
+
+bool IndexWriter::writeHeaderClose() {
+  if (!Output->writeHeaderClose())
+    return false;
+  SectionBegin = getAddress();
+  Index->setBodyBegin(SectionBegin);
+  return true;
+}
+
+void IndexWriter::closeFunctionGroup() {
+  CurGroup.NumFunctions = NumFunctions - CurGroup.FirstFunction;
+  if (CurGroup.NumFunctions > 0)
+    Groups.push_back(CurGroup);
+  CurGroup.FirstFunction = NumFunctions;
+  CurGroup.Begin = CurGroup.End;
+}
+
+bool IndexWriter::writeBlockEnter() {
+  if (!Output->writeBlockEnter())
+    return false;
+  if (Depth++ == 0) {
+    ContentBegin = getAddress();
+    NumFunctions = 0;
+    CurGroup.FirstFunction = 0;
+    CurGroup.Begin = 0;
+    CurGroup.End = 0;
+    Groups.clear();
+  }
+  return true;
+}
+
+bool IndexWriter::writeBlockExit() {
+  switch (Depth) {
+    case 0:
+      return Output->writeBlockExit();
+    case 1: {
+      // Closing section. Fix function groups, now that the position of the
+      // section contents is known.
+      if (!Output->alignToByte())
+        return false;
+      AddressType ContentSize = getAddress() - ContentBegin;
+      if (!Output->writeBlockExit())
+        return false;
+      --Depth;
+      AddressType SectionEnd = getAddress();
+      AddressType FinalContentBegin = SectionEnd - ContentSize;
+      size_t Section =
+          Index->addSection(SectionBegin, FinalContentBegin, SectionEnd);
+      closeFunctionGroup();
+      for (const FunctionGroup& Group : Groups)
+        Index->addFunctions(Section, Group.FirstFunction, Group.NumFunctions,
+                            FinalContentBegin + Group.Begin,
+                            FinalContentBegin + Group.End);
+      Groups.clear();
+      SectionBegin = SectionEnd;
+      return true;
+    }
+    case 2:
+      // Closing function body.
+      if (!Output->writeBlockExit())
+        return false;
+      --Depth;
+      ++NumFunctions;
+      CurGroup.End = getAddress() - ContentBegin;
+      if (FunctionInterval > 0 &&
+          NumFunctions - CurGroup.FirstFunction == FunctionInterval)
+        closeFunctionGroup();
+      return true;
+    default:
+      --Depth;
+      return Output->writeBlockExit();
+  }
+}
+
+bool IndexWriter::writeAction(IntType Action) {
+  // Note: Block actions are handled here, since the output would otherwise
+  // handle them directly.
+  switch (Action) {
+    case IntType(PredefinedSymbol::Block_enter):
+    case IntType(PredefinedSymbol::Block_enter_writeonly):
+      return writeBlockEnter();
+    case IntType(PredefinedSymbol::Block_exit):
+    case IntType(PredefinedSymbol::Block_exit_writeonly):
+      return writeBlockExit();
+    default:
+      return Output->writeAction(Action);
+  }
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
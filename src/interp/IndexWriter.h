@@ -0,0 +1,84 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a writer that forwards all write actions to another (byte)
+// writer, and builds the index of the written (compressed) file.
+//
+// Sections are the top-level blocks of the written data. Function bodies
+// are the blocks nested (directly) within a section. Since blocks are byte
+// aligned, the positions before each section, and after each function
+// body, are valid places to resume decompression.
+//
+// Note: When block sizes are minimized, the contents of a section are moved
+// when the size of the section is backpatched. Hence, the positions of
+// function bodies are recorded relative to the contents of the section, and
+// fixed once the section is closed.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_INDEXWRITER_H_
+#define DECOMPRESSOR_SRC_INTERP_INDEXWRITER_H_
+
+#include "interp/DecompressIndex.h"
+#include "interp/ForwardingWriter.h"
+
+namespace wasm {
+
+namespace interp {
+
+class IndexWriter : public ForwardingWriter {
+  IndexWriter() = delete;
+  IndexWriter(const IndexWriter&) = delete;
+  IndexWriter& operator=(const IndexWriter&) = delete;
+
+ public:
+  // Adds an entry to Index for each section, and each FunctionInterval
+  // function bodies (if non-zero).
+  IndexWriter(std::shared_ptr<Writer> Output,
+              std::shared_ptr<DecompressIndex> Index,
+              size_t FunctionInterval);
+  ~IndexWriter() OVERRIDE;
+
+  void reset() OVERRIDE;
+  bool writeBlockEnter() OVERRIDE;
+  bool writeBlockExit() OVERRIDE;
+  bool writeHeaderClose() OVERRIDE;
+  bool writeAction(decode::IntType Action) OVERRIDE;
+
+ private:
+  // Group of function bodies, relative to the section contents.
+  struct FunctionGroup {
+    size_t FirstFunction;
+    size_t NumFunctions;
+    decode::AddressType Begin;
+    decode::AddressType End;
+  };
+
+  std::shared_ptr<DecompressIndex> Index;
+  size_t FunctionInterval;
+  size_t Depth;
+  decode::AddressType SectionBegin;
+  decode::AddressType ContentBegin;
+  size_t NumFunctions;
+  FunctionGroup CurGroup;
+  std::vector<FunctionGroup> Groups;
+
+  void closeFunctionGroup();
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_INDEXWRITER_H_
@@ -44,42 +44,15 @@ bool isInstanceOf(IntType Value) {
   return Value == IntType(T(Value));
 }
 
-class TestBuffer {
-  TestBuffer(const TestBuffer&) = delete;
-  TestBuffer& operator-(const TestBuffer&) = delete;
-
- public:
-  TestBuffer() : Index(0) {}
-  void reset() { Index = 0; }
-  void writeByte(uint8_t Byte) {
-    (void)Byte;
-    ++Index;
-  }
-  size_t getSize() const { return Index; }
-  size_t writeVarint32(uint32_t Value) {
-    reset();
-    fmt::writeVarint32(Value, *this);
-    return getSize();
-  }
-  size_t writeVaruint32(uint32_t Value) {
-    reset();
-    fmt::writeVaruint32(Value, *this);
-    return getSize();
-  }
-  size_t writeVarint64(uint64_t Value) {
-    reset();
-    fmt::writeVarint64(Value, *this);
-    return getSize();
-  }
-  size_t writeVaruint64(uint64_t Value) {
-    reset();
-    fmt::writeVaruint64(Value, *this);
-    return getSize();
-  }
+size_t getVarint32Size(int32_t Value) {
+  return Value < 0 ? fmt::getNegativeLEB128Size(Value)
+                   : fmt::getPositiveLEB128Size(Value);
+}
 
- private:
-  size_t Index;
-};
+size_t getVarint64Size(int64_t Value) {
+  return Value < 0 ? fmt::getNegativeLEB128Size(Value)
+                   : fmt::getPositiveLEB128Size(Value);
+}
 
 }  // end of anonymous namespace
 
@@ -103,7 +76,6 @@ size_t IntTypeFormats::getByteSize(IntTypeFormat Fmt) const {
 void IntTypeFormats::cacheFormat(IntTypeFormat Fmt) const {
   size_t Index = size_t(Fmt);
   Cached[Index] = true;
-  TestBuffer Buffer;
   switch (Fmt) {
     case IntTypeFormat::Uint8:
       ByteSize[Index] =
@@ -119,22 +91,22 @@ void IntTypeFormats::cacheFormat(IntTypeFormat Fmt) const {
       break;
     case IntTypeFormat::Varint32:
       ByteSize[Index] = isInstanceOf<int32_t>(Value)
-                            ? Buffer.writeVarint32(int32_t(Value))
+                            ? getVarint32Size(int32_t(Value))
                             : NotValid;
       break;
     case IntTypeFormat::Varuint32:
       ByteSize[Index] = isInstanceOf<uint32_t>(Value)
-                            ? Buffer.writeVaruint32(uint32_t(Value))
+                            ? fmt::getLEB128Size(uint32_t(Value))
                             : NotValid;
       break;
     case IntTypeFormat::Varint64:
       ByteSize[Index] = isInstanceOf<int64_t>(Value)
-                            ? Buffer.writeVarint64(int64_t(Value))
+                            ? getVarint64Size(int64_t(Value))
                             : NotValid;
       break;
     case IntTypeFormat::Varuint64:
       ByteSize[Index] = isInstanceOf<uint64_t>(Value)
-                            ? Buffer.writeVaruint64(uint64_t(Value))
+                            ? fmt::getLEB128Size(uint64_t(Value))
                             : NotValid;
       break;
   }
@@ -0,0 +1,134 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a thread-safe, bounded pipe of (integer stream) write events.
+
+#include "interp/IntPipe.h"
+
+#include "interp/Writer.h"
+
+namespace wasm {
+
+using namespace decode;
+
+namespace interp {
+
+constexpr size_t IntPipe::DefaultPageSize;
+constexpr size_t IntPipe::DefaultMaxPages;
+
+IntPipe::IntPipe(size_t MaxPages)
+    : MaxPages(MaxPages == 0 ? 1 : MaxPages),
+      IsClosed(false),
+      IsAborted(false) {}
+
+IntPipe::~IntPipe() {}
+
+bool IntPipe::write(Page& Pg) {
+  std::unique_lock<std::mutex> Lock(Mutex);
+  NotFull.wait(Lock, [&]() {
+    return IsAborted || IsClosed || Pages.size() < MaxPages;
+  });
+  if (IsAborted || IsClosed)
+    return false;
+  Pages.emplace_back();
+  Pages.back().swap(Pg);
+  if (!FreePages.empty()) {
+    Pg.swap(FreePages.back());
+    FreePages.pop_back();
+  }
+  Lock.unlock();
+  NotEmpty.notify_one();
+  return true;
+}
+
+void IntPipe::close() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    IsClosed = true;
+  }
+  NotEmpty.notify_all();
+  NotFull.notify_all();
+}
+
+bool IntPipe::read(Page& Pg) {
+  std::unique_lock<std::mutex> Lock(Mutex);
+  NotEmpty.wait(Lock,
+                [&]() { return IsAborted || IsClosed || !Pages.empty(); });
+  if (IsAborted || Pages.empty())
+    return false;
+  Pg.clear();
+  if (FreePages.size() < MaxPages)
+    FreePages.push_back(std::move(Pg));
+  Pg.swap(Pages.front());
+  Pages.pop_front();
+  Lock.unlock();
+  NotFull.notify_one();
+  return true;
+}
+
+void IntPipe::abort() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    IsAborted = true;
+    Pages.clear();
+  }
+  NotEmpty.notify_all();
+  NotFull.notify_all();
+}
+
+bool IntPipe::isAborted() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return IsAborted;
+}
+
+bool IntPipe::replay(const Page& Pg, Writer& Output) {
+  for (const Event& E : Pg) {
+    bool Okay = true;
+    switch (E.Kind) {
+      case EventKind::Value:
+        Okay = Output.writeVaruint64(E.Value);
+        break;
+      case EventKind::BlockEnter:
+        Okay = Output.writeBlockEnter();
+        break;
+      case EventKind::BlockExit:
+        Okay = Output.writeBlockExit();
+        break;
+      case EventKind::HeaderValue:
+        Okay = Output.writeHeaderValue(E.Value, E.Format);
+        break;
+      case EventKind::HeaderClose:
+        Okay = Output.writeHeaderClose();
+        break;
+      case EventKind::TablePush:
+        Okay = Output.tablePush(E.Value);
+        break;
+      case EventKind::TablePop:
+        Okay = Output.tablePop();
+        break;
+      case EventKind::FreezeEof:
+        Okay = Output.writeFreezeEof();
+        break;
+    }
+    if (!Okay)
+      return false;
+  }
+  return true;
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
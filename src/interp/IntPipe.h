@@ -0,0 +1,104 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a thread-safe, bounded pipe of (integer stream) write events. Allows
+// one thread to generate an integer stream, while another thread consumes
+// it.
+//
+// Events are passed through the pipe in pages. The writer blocks while the
+// pipe is full, and the reader blocks while the pipe is empty. Either side
+// can abort the pipe, which wakes up (and fails) the other side.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_INTPIPE_H_
+#define DECOMPRESSOR_SRC_INTERP_INTPIPE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "interp/IntFormats.h"
+
+namespace wasm {
+
+namespace interp {
+
+class Writer;
+
+class IntPipe {
+  IntPipe(const IntPipe&) = delete;
+  IntPipe& operator=(const IntPipe&) = delete;
+
+ public:
+  enum class EventKind : uint8_t {
+    Value,
+    BlockEnter,
+    BlockExit,
+    HeaderValue,
+    HeaderClose,
+    TablePush,
+    TablePop,
+    FreezeEof
+  };
+
+  struct Event {
+    Event(EventKind Kind, decode::IntType Value, IntTypeFormat Format)
+        : Kind(Kind), Format(Format), Value(Value) {}
+    EventKind Kind;
+    IntTypeFormat Format;
+    decode::IntType Value;
+  };
+
+  typedef std::vector<Event> Page;
+
+  static constexpr size_t DefaultPageSize = 4096;
+  static constexpr size_t DefaultMaxPages = 16;
+
+  explicit IntPipe(size_t MaxPages = DefaultMaxPages);
+  ~IntPipe();
+
+  // Moves the events of Pg into the pipe, blocking while the pipe is
+  // full. Returns false if the pipe was aborted (or closed).
+  bool write(Page& Pg);
+  // Marks that no more pages will be written.
+  void close();
+  // Moves the next page of the pipe into Pg, blocking while the pipe is
+  // empty. Returns false if the pipe is closed (and empty), or aborted.
+  bool read(Page& Pg);
+  // Stops the pipe, discarding pages not yet read.
+  void abort();
+  bool isAborted();
+
+  // Applies the events of Pg to Output. Returns false if unable to write.
+  static bool replay(const Page& Pg, Writer& Output);
+
+ private:
+  std::mutex Mutex;
+  std::condition_variable NotEmpty;
+  std::condition_variable NotFull;
+  std::deque<Page> Pages;
+  // Recycled (empty) pages, so that pages keep their capacity.
+  std::vector<Page> FreePages;
+  size_t MaxPages;
+  bool IsClosed;
+  bool IsAborted;
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_INTPIPE_H_
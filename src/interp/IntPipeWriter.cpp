@@ -0,0 +1,96 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a writer of an integer stream that sends the written integer
+// stream (in pages) through an integer pipe.
+
+#include "interp/IntPipeWriter.h"
+
+#include <functional>
+
+#include "interp/FormattedValue-templates.h"
+#include "sexp/Ast.h"
+
+namespace wasm {
+
+using namespace decode;
+using namespace filt;
+
+namespace interp {
+
+IntPipeWriter::IntPipeWriter(std::shared_ptr<IntPipe> Output, size_t PageSize)
+    : Writer(true), Output(Output), PageSize(PageSize == 0 ? 1 : PageSize) {
+  Buffer.reserve(this->PageSize);
+}
+
+IntPipeWriter::~IntPipeWriter() {}
+
+void IntPipeWriter::reset() {
+  Buffer.clear();
+}
+
+const char* IntPipeWriter::getDefaultTraceName() const {
+  return "IntPipeWriter";
+}
+
+StreamType IntPipeWriter::getStreamType() const {
+  return StreamType::Int;
+}
+
+bool IntPipeWriter::flush() {
+  if (Buffer.empty())
+    return true;
+  return Output->write(Buffer);
+}
+
+bool IntPipeWriter::writeValue(IntType Value, const Node* Format) {
+  return writeFormattedValue(*this, Value, Format);
+}
+
+bool IntPipeWriter::writeBlockEnter() {
+  return add(IntPipe::EventKind::BlockEnter);
+}
+
+bool IntPipeWriter::writeBlockExit() {
+  return add(IntPipe::EventKind::BlockExit);
+}
+
+bool IntPipeWriter::writeFreezeEof() {
+  Buffer.emplace_back(IntPipe::EventKind::FreezeEof, 0, IntTypeFormat::Uint8);
+  bool Okay = flush();
+  Output->close();
+  return Okay;
+}
+
+bool IntPipeWriter::writeHeaderValue(IntType Value, IntTypeFormat Format) {
+  return add(IntPipe::EventKind::HeaderValue, Value, Format);
+}
+
+bool IntPipeWriter::writeHeaderClose() {
+  return add(IntPipe::EventKind::HeaderClose);
+}
+
+bool IntPipeWriter::tablePush(IntType Value) {
+  return add(IntPipe::EventKind::TablePush, Value);
+}
+
+bool IntPipeWriter::tablePop() {
+  return add(IntPipe::EventKind::TablePop);
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
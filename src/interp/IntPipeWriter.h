@@ -0,0 +1,86 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a writer of an integer stream that sends the written integer
+// stream (in pages) through an integer pipe. Used to pass an integer stream
+// to an algorithm running on another thread (see IntPipe::replay()).
+
+#ifndef DECOMPRESSOR_SRC_INTERP_INTPIPEWRITER_H_
+#define DECOMPRESSOR_SRC_INTERP_INTPIPEWRITER_H_
+
+#include "interp/IntPipe.h"
+#include "interp/Writer.h"
+
+namespace wasm {
+
+namespace interp {
+
+class IntPipeWriter FINAL : public Writer {
+  IntPipeWriter() = delete;
+  IntPipeWriter(const IntPipeWriter&) = delete;
+  IntPipeWriter& operator=(const IntPipeWriter&) = delete;
+
+ public:
+  IntPipeWriter(std::shared_ptr<IntPipe> Output,
+                size_t PageSize = IntPipe::DefaultPageSize);
+  ~IntPipeWriter() OVERRIDE;
+  void reset() OVERRIDE;
+  decode::StreamType getStreamType() const OVERRIDE;
+  bool write(decode::IntType Value) {
+    return add(IntPipe::EventKind::Value, Value);
+  }
+  bool writeBit(uint8_t Value) OVERRIDE { return write(Value & 0x1); }
+  bool writeUint8(uint8_t Value) OVERRIDE { return write(Value); }
+  bool writeUint32(uint32_t Value) OVERRIDE { return write(Value); }
+  bool writeUint64(uint64_t Value) OVERRIDE { return write(Value); }
+  bool writeVarint32(int32_t Value) OVERRIDE { return write(Value); }
+  bool writeVarint64(int64_t Value) OVERRIDE { return write(Value); }
+  bool writeVaruint32(uint32_t Value) OVERRIDE { return write(Value); }
+  bool writeVaruint64(uint64_t Value) OVERRIDE { return write(Value); }
+  bool writeValue(decode::IntType Value, const filt::Node* Format) OVERRIDE;
+  bool writeBlockEnter() OVERRIDE;
+  bool writeBlockExit() OVERRIDE;
+  bool writeFreezeEof() OVERRIDE;
+  bool writeHeaderValue(decode::IntType Value,
+                        interp::IntTypeFormat Format) OVERRIDE;
+  bool writeHeaderClose() OVERRIDE;
+  bool tablePush(decode::IntType Value) OVERRIDE;
+  bool tablePop() OVERRIDE;
+
+  // Sends the buffered events through the pipe. Returns false if the pipe
+  // was aborted.
+  bool flush();
+
+ private:
+  std::shared_ptr<IntPipe> Output;
+  IntPipe::Page Buffer;
+  size_t PageSize;
+
+  bool add(IntPipe::EventKind Kind,
+           decode::IntType Value = 0,
+           IntTypeFormat Format = IntTypeFormat::Uint8) {
+    Buffer.emplace_back(Kind, Value, Format);
+    return Buffer.size() < PageSize || flush();
+  }
+
+  const char* getDefaultTraceName() const OVERRIDE;
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_INTPIPEWRITER_H_
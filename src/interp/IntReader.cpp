@@ -18,6 +18,7 @@
 
 #include "interp/IntReader.h"
 
+#include "interp/FormattedValue-templates.h"
 #include "interp/Interpreter.h"
 #include "sexp/Ast.h"
 
@@ -158,6 +159,10 @@ uint64_t IntReader::readVaruint64() {
   return read();
 }
 
+bool IntReader::readValue(const filt::Node* Format, IntType& Value) {
+  return readFormattedValue(*this, Format, Value);
+}
+
 bool IntReader::readHeaderValue(IntTypeFormat Format, IntType& Value) {
   const IntStream::HeaderVector& Header = Input->getHeader();
   Value = 0;  // Default value for failure.
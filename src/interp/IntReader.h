@@ -28,7 +28,7 @@ namespace wasm {
 
 namespace interp {
 
-class IntReader : public Reader {
+class IntReader FINAL : public Reader {
   IntReader(const IntReader&) = delete;
   IntReader& operator=(const IntReader&) = delete;
 
@@ -54,7 +54,15 @@ class IntReader : public Reader {
   bool processedInputCorrectly(bool CheckForEof) OVERRIDE;
   void readFillStart() OVERRIDE;
   void readFillMoreInput() OVERRIDE;
+  uint8_t readBit() OVERRIDE { return read() & 0x1; }
+  uint8_t readUint8() OVERRIDE { return uint8_t(read()); }
+  uint32_t readUint32() OVERRIDE { return uint32_t(read()); }
+  uint64_t readUint64() OVERRIDE { return uint64_t(read()); }
+  int32_t readVarint32() OVERRIDE { return int32_t(read()); }
+  int64_t readVarint64() OVERRIDE { return int64_t(read()); }
+  uint32_t readVaruint32() OVERRIDE { return uint32_t(read()); }
   uint64_t readVaruint64() OVERRIDE;
+  bool readValue(const filt::Node* Format, decode::IntType& Value) OVERRIDE;
   bool readBlockEnter() OVERRIDE;
   bool readBlockExit() OVERRIDE;
   bool readHeaderValue(interp::IntTypeFormat Format,
@@ -175,15 +175,13 @@ bool IntStream::WriteCursor::closeBlock() {
   return true;
 }
 
-IntStream::ReadCursor::ReadCursor() : Cursor() {}
+IntStream::ReadCursor::ReadCursor() : Cursor(), NextBlock(0) {}
 
 IntStream::ReadCursor::ReadCursor(Ptr Stream)
-    : Cursor(Stream),
-      NextBlock(Stream->getBlocksBegin()),
-      EndBlocks(Stream->getBlocksEnd()) {}
+    : Cursor(Stream), NextBlock(0) {}
 
 IntStream::ReadCursor::ReadCursor(const ReadCursor& C)
-    : Cursor(C), NextBlock(C.NextBlock), EndBlocks(C.EndBlocks) {}
+    : Cursor(C), NextBlock(C.NextBlock) {}
 
 IntStream::ReadCursor::~ReadCursor() {}
 
@@ -196,9 +194,9 @@ IntType IntStream::ReadCursor::read() {
 }
 
 bool IntStream::ReadCursor::openBlock() {
-  if (NextBlock == EndBlocks)
+  if (!hasMoreBlocks())
     return false;
-  BlockPtr Blk = *NextBlock;
+  BlockPtr Blk = getNextBlock();
   if (Index != Blk->getBeginIndex())
     return false;
   assert(!EnclosingBlocks.empty());
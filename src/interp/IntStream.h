@@ -116,18 +116,19 @@ class IntStream : public std::enable_shared_from_this<IntStream> {
     ReadCursor& operator=(const ReadCursor& C) {
       Cursor::operator=(C);
       NextBlock = C.NextBlock;
-      EndBlocks = C.EndBlocks;
       return *this;
     }
     decode::IntType read();
     bool openBlock();
     bool closeBlock();
-    bool hasMoreBlocks() const { return NextBlock != EndBlocks; }
-    BlockPtr getNextBlock() const { return *NextBlock; }
+    bool hasMoreBlocks() const { return NextBlock < Stream->getNumBlocks(); }
+    BlockPtr getNextBlock() const { return Stream->getBlock(NextBlock); }
 
    private:
-    IntStream::BlockIterator NextBlock;
-    IntStream::BlockIterator EndBlocks;
+    // Index (into the written blocks of the stream) of the next block to
+    // open. Note: An index (rather than an iterator) is used so that the
+    // stream can be read while it is still being written.
+    size_t NextBlock;
   };
 
   // WARNING: Don't call constructor directly. Call std::make_shared().
@@ -142,6 +143,8 @@ class IntStream : public std::enable_shared_from_this<IntStream> {
 
   BlockIterator getBlocksBegin();
   BlockIterator getBlocksEnd();
+  size_t getNumBlocks() const { return Blocks.size(); }
+  BlockPtr getBlock(size_t Index) const { return Blocks[Index]; }
 
   void describe(FILE* File, const char* Name = nullptr);
 
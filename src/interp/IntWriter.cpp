@@ -21,6 +21,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "interp/FormattedValue-templates.h"
 #include "sexp/Ast.h"
 
 namespace wasm {
@@ -139,6 +140,10 @@ bool IntWriter::writeVaruint64(uint64_t Value) {
   return write(Value);
 }
 
+bool IntWriter::writeValue(IntType Value, const Node* Format) {
+  return writeFormattedValue(*this, Value, Format);
+}
+
 bool IntWriter::writeBlockEnter() {
   return Pos.openBlock();
 }
@@ -26,7 +26,7 @@ namespace wasm {
 
 namespace interp {
 
-class IntWriter : public Writer {
+class IntWriter FINAL : public Writer {
   IntWriter() = delete;
   IntWriter(const IntWriter&) = delete;
   IntWriter& operator=(const IntWriter&) = delete;
@@ -37,7 +37,15 @@ class IntWriter : public Writer {
   void reset() OVERRIDE;
   decode::StreamType getStreamType() const OVERRIDE;
   bool write(decode::IntType Value) { return Pos.write(Value); }
+  bool writeBit(uint8_t Value) OVERRIDE { return write(Value & 0x1); }
+  bool writeUint8(uint8_t Value) OVERRIDE { return write(Value); }
+  bool writeUint32(uint32_t Value) OVERRIDE { return write(Value); }
+  bool writeUint64(uint64_t Value) OVERRIDE { return write(Value); }
+  bool writeVarint32(int32_t Value) OVERRIDE { return write(Value); }
+  bool writeVarint64(int64_t Value) OVERRIDE { return write(Value); }
+  bool writeVaruint32(uint32_t Value) OVERRIDE { return write(Value); }
   bool writeVaruint64(uint64_t Value) OVERRIDE;
+  bool writeValue(decode::IntType Value, const filt::Node* Format) OVERRIDE;
   bool writeBlockEnter() OVERRIDE;
   bool writeBlockExit() OVERRIDE;
   bool writeFreezeEof() OVERRIDE;
@@ -39,6 +39,7 @@
   X(CopyBlock)                    \
   X(Eval)                         \
   X(EvalBlock)                    \
+  X(EvalBytecode)                 \
   X(EvalInCallingContext)         \
   X(Finished)                     \
   X(GetAlgorithm)                 \
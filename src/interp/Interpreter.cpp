@@ -19,11 +19,16 @@
 
 #include "interp/Interpreter.h"
 
+#include <algorithm>
+
 #include "interp/AlgorithmSelector.h"
+#include "interp/Bytecode.h"
 #include "interp/Reader.h"
 #include "interp/Writer.h"
 #include "sexp/Ast.h"
 #include "sexp/TextWriter.h"
+#include "stream/ReadCursor.h"
+#include "stream/WriteCursor.h"
 #include "utils/Casting.h"
 #include "utils/Trace.h"
 
@@ -72,6 +77,10 @@ static constexpr uint32_t MaxExpectedSectionNameSize = 32;
 static constexpr size_t DefaultStackSize = 256;
 static constexpr size_t DefaultExpectedLocals = 3;
 
+// The maximum number of values read (and then written) at once by a bulk
+// loop.
+static constexpr size_t LoopValueBatchSize = 256;
+
 const char* SectionCodeName[] = {
 #define X(code, value) #code
     SECTION_CODES_TABLE
@@ -105,7 +114,8 @@ InterpreterFlags::InterpreterFlags()
     : MacroContext(MacroDirective::Expand),
       TraceProgress(false),
       TraceIntermediateStreams(false),
-      TraceAppliedAlgorithms(false) {}
+      TraceAppliedAlgorithms(false),
+      UseBytecode(true) {}
 
 Interpreter::CallFrame::CallFrame() {
   reset();
@@ -115,13 +125,17 @@ Interpreter::CallFrame::CallFrame(Method CallMethod, const filt::Node* Nd)
     : CallMethod(CallMethod),
       CallState(State::Enter),
       CallModifier(MethodModifier::ReadAndWrite),
-      Nd(Nd) {}
+      Nd(Nd),
+      Code(nullptr),
+      Pc(0) {}
 
 Interpreter::CallFrame::CallFrame(const CallFrame& M)
     : CallMethod(M.CallMethod),
       CallState(M.CallState),
       CallModifier(M.CallModifier),
-      Nd(M.Nd) {}
+      Nd(M.Nd),
+      Code(M.Code),
+      Pc(M.Pc) {}
 
 void Interpreter::CallFrame::reset() {
   CallMethod = Method::Started;
@@ -129,6 +143,8 @@ void Interpreter::CallFrame::reset() {
   CallModifier = MethodModifier::ReadAndWrite;
   Nd = nullptr;
   ReturnValue = 0;
+  Code = nullptr;
+  Pc = 0;
 }
 
 void Interpreter::CallFrame::fail() {
@@ -137,6 +153,8 @@ void Interpreter::CallFrame::fail() {
   CallModifier = MethodModifier::ReadAndWrite;
   Nd = nullptr;
   ReturnValue = 0;
+  Code = nullptr;
+  Pc = 0;
 }
 
 Interpreter::EvalFrame::EvalFrame() {
@@ -145,62 +163,32 @@ Interpreter::EvalFrame::EvalFrame() {
 
 Interpreter::EvalFrame::EvalFrame(const Eval* Caller,
                                   const DefineFrame* DefinedFrame,
-                                  size_t CallingEvalIndex)
+                                  size_t CallingEvalIndex,
+                                  size_t ValuesBase)
     : Caller(Caller),
       DefinedFrame(DefinedFrame),
       CallingEvalIndex(CallingEvalIndex),
-      Values(DefinedFrame->getNumValues(), 0) {}
-
-Interpreter::EvalFrame::EvalFrame(const EvalFrame& F)
-    : Caller(F.Caller),
-      DefinedFrame(F.DefinedFrame),
-      CallingEvalIndex(F.CallingEvalIndex),
-      Values(F.Values) {}
-
-Interpreter::EvalFrame& Interpreter::EvalFrame::operator=(const EvalFrame& F) {
-  Caller = F.Caller;
-  DefinedFrame = F.DefinedFrame;
-  CallingEvalIndex = F.CallingEvalIndex;
-  Values = F.Values;
-  return *this;
-}
+      ValuesBase(ValuesBase) {}
 
 bool Interpreter::EvalFrame::isDefined() const {
   return Caller != nullptr;
 }
 
-decode::IntType Interpreter::EvalFrame::getValueParam(size_t Index) const {
-  assert(Index < Values.size());
-  return Values[Index];
-}
-
-void Interpreter::EvalFrame::setValueParam(size_t Index,
-                                           decode::IntType Value) {
-  assert(Index < Values.size());
-  Values[Index] = Value;
-}
-
-decode::IntType Interpreter::EvalFrame::getLocal(size_t Index) const {
-  size_t FixedIndex = DefinedFrame->getNumValueArgs() + Index;
-  assert(FixedIndex < Values.size());
-  return Values[FixedIndex];
-}
-
-void Interpreter::EvalFrame::setLocal(size_t Index, decode::IntType Value) {
-  size_t FixedIndex = DefinedFrame->getNumValueArgs() + Index;
-  assert(FixedIndex < Values.size());
-  Values[FixedIndex] = Value;
+size_t Interpreter::EvalFrame::getNumValues() const {
+  return DefinedFrame == nullptr ? 0 : DefinedFrame->getNumValues();
 }
 
 void Interpreter::EvalFrame::reset() {
   Caller = nullptr;
   DefinedFrame = nullptr;
   CallingEvalIndex = 0;
-  Values.clear();
+  ValuesBase = 0;
 }
 
 void Interpreter::setInput(std::shared_ptr<Reader> Value) {
   Input = Value;
+  // Force resume() to exit, so that the new input gets filled.
+  CheckInputAvailable = true;
   if (Trace) {
     Trace->clearContexts();
     setTrace(Trace);
@@ -215,6 +203,18 @@ void Interpreter::setWriter(std::shared_ptr<Writer> Value) {
   }
 }
 
+void Interpreter::setSymbolTable(std::shared_ptr<SymbolTable> NewSymtab) {
+  // Note: Compiled bytecode refers to nodes of the symbol table.
+  if (NewSymtab != Symtab)
+    BytecodeCache.clear();
+  Symtab = NewSymtab;
+}
+
+void Interpreter::resetSymbolTable() {
+  BytecodeCache.clear();
+  Symtab.reset();
+}
+
 void Interpreter::addSelector(std::shared_ptr<AlgorithmSelector> Selector) {
   assert(!Symtab &&
          "Can't add selectors if symbol table defined at construction");
@@ -294,6 +294,10 @@ Interpreter::Interpreter(std::shared_ptr<Reader> Input,
       CatchState(State::NO_SUCH_STATE),
       IsFatalFailure(false),
       CheckForEof(true),
+      CheckInputAvailable(true),
+      StepBudget(0),
+      StepsLeft(0),
+      StepBudgetUsedUp(false),
       FrameStack(Frame),
       LoopCounter(0),
       LoopCounterStack(LoopCounter),
@@ -339,6 +343,8 @@ void Interpreter::init() {
   LocalsBaseStack.reserve(DefaultStackSize);
   LocalValues.reserve(DefaultStackSize * DefaultExpectedLocals);
   OpcodeLocalsStack.reserve(DefaultStackSize);
+  LoopBytes.resize(LoopValueBatchSize);
+  LoopWords.resize(LoopValueBatchSize);
 }
 
 Interpreter::~Interpreter() {}
@@ -359,6 +365,8 @@ void Interpreter::CallFrame::describe(FILE* File, TextWriter* Writer) const {
   fprintf(File, "%s.%s (%s) = ", getName(CallMethod), getName(CallState),
           getName(CallModifier));
   fprint_IntType(File, ReturnValue);
+  if (CallMethod == Method::EvalBytecode)
+    fprintf(File, " (pc = %" PRIuMAX ")", uintmax_t(Pc));
   fputs(": ", File);
   if (Nd)
     Writer->writeAbbrev(File, Nd);
@@ -366,12 +374,14 @@ void Interpreter::CallFrame::describe(FILE* File, TextWriter* Writer) const {
     fprintf(File, "nullptr\n");
 }
 
-void Interpreter::EvalFrame::describe(FILE* File, TextWriter* Writer) const {
+void Interpreter::EvalFrame::describe(FILE* File,
+                                      TextWriter* Writer,
+                                      const IntType* Values) const {
   fprintf(File, "cc = %" PRIuMAX ": ", uintmax_t(CallingEvalIndex));
   Writer->writeAbbrev(File, Caller);
-  for (size_t i = 0; i < Values.size(); ++i)
+  for (size_t i = 0, NumValues = getNumValues(); i < NumValues; ++i)
     fprintf(File, "v[%" PRIuMAX "] = %" PRIuMAX "\n", uintmax_t(i),
-            uintmax_t(Values[i]));
+            uintmax_t(Values[ValuesBase + i]));
 }
 
 void Interpreter::OpcodeLocalsFrame::describe(FILE* File,
@@ -396,7 +406,7 @@ void Interpreter::describeCallingEvalStack(FILE* File) {
   fprintf(File, "*** Eval Call Stack ****\n");
   TextWriter Writer;
   for (const auto& Frame : EvalFrameStack)
-    Frame->describe(File, &Writer);
+    Frame.describe(File, &Writer, LocalValues.data());
   fprintf(File, "*** Current Eval Call Stack ***\n");
   for (size_t Index : CurEvalFrameStack)
     fprintf(File, "%" PRIuMAX "\n", uintmax_t(Index));
@@ -509,10 +519,254 @@ void Interpreter::callTopLevel(Method Method, const filt::Node* Nd) {
   call(Method, MethodModifier::ReadAndWrite, Nd);
 }
 
+const Bytecode* Interpreter::getBytecode(const Node* Nd,
+                                         MethodModifier Modifier) {
+  std::unique_ptr<Bytecode>& Code =
+      BytecodeCache[std::make_pair(Nd, Modifier)];
+  if (!Code)
+    Code = Bytecode::compile(Nd, uint32_t(Modifier));
+  return Code.get();
+}
+
+void Interpreter::evalBytecode() {
+  // Note: The accumulator (i.e. the value of the last evaluated expression)
+  // is kept in Frame.ReturnValue while suspended, so that the value returned
+  // by a called method is picked up when resumed.
+  const Bytecode::Instruction* Code = Frame.Code->getCode();
+  size_t Pc = Frame.Pc;
+  IntType Acc = Frame.ReturnValue;
+  while (true) {
+    const Bytecode::Instruction& Inst = Code[Pc];
+    if (Bytecode::readsInput(Inst.Op) &&
+        ((CheckInputAvailable && !Input->stillMoreInputToProcessNow()) ||
+         !takeStep())) {
+      Frame.Pc = Pc;
+      Frame.ReturnValue = Acc;
+      return;
+    }
+    ++Pc;
+    switch (Inst.Op) {
+      case Bytecode::Opcode::NO_SUCH_OPCODE:
+        return failBadState();
+      case Bytecode::Opcode::Action:
+        if (!Input->readAction(Inst.Arg))
+          return throwCantRead();
+        if (!Output->writeAction(Inst.Arg))
+          return throwCantWrite();
+        Acc = LastReadValue;
+        break;
+      case Bytecode::Opcode::Binary:
+        if (Inst.Arg & Bytecode::ReadFlag) {
+          if (!Input->readBinary(Inst.Nd, LastReadValue))
+            return throwCantRead();
+        }
+        if (Inst.Arg & Bytecode::WriteFlag) {
+          if (!Output->writeBinary(LastReadValue, Inst.Nd))
+            return throwCantWrite();
+        }
+        Acc = LastReadValue;
+        break;
+      case Bytecode::Opcode::BlockEnter: {
+        IntType EnterBlock = IntType(PredefinedSymbol::Block_enter);
+        if (!Input->readAction(EnterBlock) || !Output->writeAction(EnterBlock))
+          return fatal("Unable to enter block");
+        break;
+      }
+      case Bytecode::Opcode::BlockExit: {
+        IntType ExitBlock = IntType(PredefinedSymbol::Block_exit);
+        if (!Input->readAction(ExitBlock) || !Output->writeAction(ExitBlock))
+          return fatal("unable to close block");
+        break;
+      }
+      case Bytecode::Opcode::BitwiseAnd:
+        Acc = LocalValues.back() & Acc;
+        LocalValues.pop_back();
+        break;
+      case Bytecode::Opcode::BitwiseOr:
+        Acc = LocalValues.back() | Acc;
+        LocalValues.pop_back();
+        break;
+      case Bytecode::Opcode::BitwiseXor:
+        Acc = LocalValues.back() ^ Acc;
+        LocalValues.pop_back();
+        break;
+      case Bytecode::Opcode::BitwiseNegate:
+        Acc = ~Acc;
+        break;
+      case Bytecode::Opcode::CallTree:
+        Frame.Pc = Pc;
+        call(Method::Eval, MethodModifier(Inst.Arg), Inst.Nd);
+        return;
+      case Bytecode::Opcode::Const:
+        Acc = Inst.Arg;
+        break;
+      case Bytecode::Opcode::CopyBlock:
+        if (!copyBlockBytes())
+          return throwCantWrite();
+        if (CheckInputAvailable && !Input->stillMoreInputToProcessNow()) {
+          Frame.Pc = Pc - 1;
+          Frame.ReturnValue = Acc;
+          return;
+        }
+        break;
+      case Bytecode::Opcode::GetLocal:
+        if (LocalsBase + Inst.Arg >= LocalValues.size())
+          return throwMessage("Local variable index out of range!");
+        Acc = LocalValues[LocalsBase + Inst.Arg];
+        break;
+      case Bytecode::Opcode::Jump:
+        Pc = Inst.Arg;
+        break;
+      case Bytecode::Opcode::JumpIfEob:
+        if (Input->atInputEob())
+          Pc = Inst.Arg;
+        break;
+      case Bytecode::Opcode::JumpIfNonZero:
+        if (Acc != 0)
+          Pc = Inst.Arg;
+        break;
+      case Bytecode::Opcode::JumpIfZero:
+        if (Acc == 0)
+          Pc = Inst.Arg;
+        break;
+      case Bytecode::Opcode::LastRead:
+        Acc = LastReadValue;
+        break;
+      case Bytecode::Opcode::Literal:
+        LastReadValue = Acc = Inst.Arg;
+        break;
+      case Bytecode::Opcode::LoopEnter:
+        LoopCounterStack.push(Acc);
+        break;
+      case Bytecode::Opcode::LoopNext:
+        if (LoopCounter-- == 0) {
+          LoopCounterStack.pop();
+          Pc = Inst.Arg;
+        }
+        break;
+      case Bytecode::Opcode::LoopValue:
+        while (LoopCounter > 0) {
+          // Note: Only the first value of a batch is guaranteed to be
+          // available, so recheck before each batch.
+          if (CheckInputAvailable && !Input->stillMoreInputToProcessNow()) {
+            Frame.Pc = Pc - 1;
+            Frame.ReturnValue = Acc;
+            return;
+          }
+          size_t Count = LoopCounter < LoopValueBatchSize ? LoopCounter
+                                                          : LoopValueBatchSize;
+          if (!readLoopValues(Inst.Nd, Count))
+            return throwCantRead();
+          if ((Inst.Arg & Bytecode::WriteFlag) &&
+              !writeLoopValues(Inst.Nd, Count))
+            return throwCantWrite();
+          LoopCounter -= Count;
+          if (LoopCounter > 0 && !takeStep()) {
+            Frame.Pc = Pc - 1;
+            Frame.ReturnValue = Acc;
+            return;
+          }
+        }
+        LoopCounterStack.pop();
+        break;
+      case Bytecode::Opcode::PopPeekPos:
+        if (!Input->popPeekPos())
+          return failBadState();
+        break;
+      case Bytecode::Opcode::Push:
+        LocalValues.push_back(Acc);
+        break;
+      case Bytecode::Opcode::PushPeekPos:
+        if (!Input->pushPeekPos())
+          return failBadState();
+        break;
+      case Bytecode::Opcode::Return:
+        return popAndReturn(Acc);
+      case Bytecode::Opcode::SetLocal:
+        if (LocalsBase + Inst.Arg >= LocalValues.size())
+          return throwMessage("Local variable index out of range, can't set!");
+        LocalValues[LocalsBase + Inst.Arg] = Acc;
+        Acc = LastReadValue;
+        break;
+      case Bytecode::Opcode::SetLastRead:
+        LastReadValue = Acc;
+        break;
+      case Bytecode::Opcode::Switch:
+        Pc = Frame.Code->getJumpTable(Inst.Arg).getTarget(Acc);
+        break;
+      case Bytecode::Opcode::Value:
+        if (Inst.Arg & Bytecode::ReadFlag) {
+          if (!Input->readValue(Inst.Nd, LastReadValue))
+            return throwCantRead();
+        }
+        if (Inst.Arg & Bytecode::WriteFlag) {
+          if (!Output->writeValue(LastReadValue, Inst.Nd))
+            return throwCantWrite();
+        }
+        Acc = LastReadValue;
+        break;
+    }
+  }
+}
+
+bool Interpreter::copyBlockBytes() {
+  ReadCursor* ReadPos = Input->getBytePos();
+  WriteCursor* WritePos = Output->getBytePos();
+  while (!CheckInputAvailable || Input->stillMoreInputToProcessNow()) {
+    if (Input->atInputEob())
+      return true;
+    size_t Count = 0;
+    if (ReadPos != nullptr && WritePos != nullptr)
+      Count = std::min(ReadPos->getContiguousBytesAvailable(),
+                       WritePos->getContiguousBytesAvailable());
+    if (Count == 0) {
+      // At a page boundary (or not byte streams), copy a single byte.
+      LastReadValue = Input->readUint8();
+      if (!Output->writeUint8(LastReadValue))
+        return false;
+      continue;
+    }
+    const uint8_t* Bytes = ReadPos->getBufferPtr();
+    memcpy(WritePos->getBufferPtr(), Bytes, Count);
+    LastReadValue = Bytes[Count - 1];
+    ReadPos->consumeContiguousBytes(Count);
+    WritePos->consumeContiguousBytes(Count);
+  }
+  return true;
+}
+
+bool Interpreter::readLoopValues(const Node* Format, size_t& Count) {
+  switch (Format->getType()) {
+    case NodeType::Uint8:
+      Count = Input->readUint8Array(LoopBytes.data(), Count);
+      LastReadValue = LoopBytes[Count - 1];
+      return true;
+    case NodeType::Varuint32:
+      Count = Input->readVaruint32Array(LoopWords.data(), Count);
+      LastReadValue = LoopWords[Count - 1];
+      return true;
+    default:
+      // Other formats are applied one value at a time.
+      Count = 1;
+      return Input->readValue(Format, LastReadValue);
+  }
+}
+
+bool Interpreter::writeLoopValues(const Node* Format, size_t Count) {
+  switch (Format->getType()) {
+    case NodeType::Uint8:
+      return Output->writeUint8Array(LoopBytes.data(), Count);
+    case NodeType::Varuint32:
+      return Output->writeVaruint32Array(LoopWords.data(), Count);
+    default:
+      return Output->writeValue(LastReadValue, Format);
+  }
+}
+
 Interpreter::EvalFrame* Interpreter::getCurrentEvalFrame() {
   if (EvalFrameStack.empty() || CurEvalFrameStack.empty())
     return nullptr;
-  return EvalFrameStack[CurEvalFrameStack.back()].get();
+  return &EvalFrameStack[CurEvalFrameStack.back()];
 }
 
 void Interpreter::catchOrElseFail() {
@@ -705,9 +959,13 @@ void Interpreter::algorithmResume() {
   TRACE_METHOD("resume");
   TRACE_BLOCK({ describeState(tracE.getFile()); });
 #endif
+  StepsLeft = StepBudget;
+  StepBudgetUsedUp = false;
   if (!Input->canProcessMoreInputNow())
     return;
-  while (Input->stillMoreInputToProcessNow()) {
+  // Only check for more input if a read might block.
+  CheckInputAvailable = !Input->isAllInputAvailable();
+  while (!CheckInputAvailable || Input->stillMoreInputToProcessNow()) {
     if (errorsFound())
       break;
 #if LOG_CALLSTACKS
@@ -722,12 +980,10 @@ void Interpreter::algorithmResume() {
             Frame.CallState = State::Loop;
             break;
           case State::Loop:
-            if (Input->atInputEob()) {
+            if (!copyBlockBytes())
+              return throwCantWrite();
+            if (!CheckInputAvailable || Input->stillMoreInputToProcessNow())
               Frame.CallState = State::Exit;
-              break;
-            }
-            LastReadValue = Input->readUint8();
-            Output->writeUint8(LastReadValue);
             break;
           case State::Exit:
             popAndReturn();
@@ -1229,6 +1485,12 @@ void Interpreter::algorithmResume() {
           case NodeType::LoopUnbounded:  // Method::Eval
             switch (Frame.CallState) {
               case State::Enter:
+                if (Frame.CallModifier == MethodModifier::ReadAndWrite &&
+                    Frame.Nd->getKid(0)->getType() == NodeType::Uint8) {
+                  Frame.CallState = State::Exit;
+                  call(Method::CopyBlock, Frame.CallModifier, nullptr);
+                  break;
+                }
                 Frame.CallState = State::Loop;
                 break;
               case State::Loop:
@@ -1327,18 +1589,24 @@ void Interpreter::algorithmResume() {
                 const Define* Def = cast<Define>(Frame.Nd);
                 if (size_t NumLocals = Def->getNumLocals()) {
                   LocalsBaseStack.push(LocalValues.size());
-                  for (size_t i = 0; i < NumLocals; ++i)
-                    LocalValues.push_back(0);
+                  LocalValues.resize(LocalsBase + NumLocals, 0);
                 }
                 Frame.CallState = State::Exit;
-                call(Method::Eval, Frame.CallModifier, Def->getBody());
+                if (!Flags.UseBytecode) {
+                  call(Method::Eval, Frame.CallModifier, Def->getBody());
+                  break;
+                }
+                const Bytecode* Code =
+                    getBytecode(Def->getBody(), Frame.CallModifier);
+                call(Method::EvalBytecode, Frame.CallModifier, Def->getBody());
+                Frame.Code = Code;
+                Frame.Pc = 0;
                 break;
               }
               case State::Exit: {
                 const Define* Def = cast<Define>(Frame.Nd);
                 if (Def->getNumLocals()) {
-                  while (LocalValues.size() > LocalsBase)
-                    LocalValues.pop_back();
+                  LocalValues.resize(LocalsBase);
                   LocalsBaseStack.pop();
                 }
                 popAndReturn();
@@ -1367,7 +1635,8 @@ void Interpreter::algorithmResume() {
                         CallingFrame->DefinedFrame->getValueArgIndex(
                             ParamIndex);
                     Frame.CallState = State::Exit;
-                    Frame.ReturnValue = CallingFrame->Values[ValueIndex];
+                    Frame.ReturnValue =
+                        LocalValues[CallingFrame->ValuesBase + ValueIndex];
                     TRACE(size_t, "Param value", Frame.ReturnValue);
                     break;
                   }
@@ -1474,9 +1743,10 @@ void Interpreter::algorithmResume() {
                 }
                 size_t CallingEvalIndex = EvalFrameStack.size();
                 CurEvalFrameStack.push_back(CallingEvalIndex);
-                std::unique_ptr<EvalFrame> CalledFrame = make_unique<EvalFrame>(
-                    cast<Eval>(Frame.Nd), DefFrame, CallingEvalIndex);
-                EvalFrameStack.push_back(std::move(CalledFrame));
+                size_t ValuesBase = LocalValues.size();
+                EvalFrameStack.emplace_back(cast<Eval>(Frame.Nd), DefFrame,
+                                            CallingEvalIndex, ValuesBase);
+                LocalValues.resize(ValuesBase + DefFrame->getNumValues(), 0);
                 LoopCounterStack.push(0);
                 LoopSizeStack.push_back(DefFrame->getNumValueArgs());
                 Frame.CallState = State::Loop;
@@ -1500,7 +1770,7 @@ void Interpreter::algorithmResume() {
                 TRACE(IntType, "Value parameter", Frame.ReturnValue);
                 size_t ValArg =
                     EvalFrame->DefinedFrame->getValueArgIndex(LoopCounter);
-                EvalFrame->Values[ValArg] = Frame.ReturnValue;
+                LocalValues[EvalFrame->ValuesBase + ValArg] = Frame.ReturnValue;
                 ++LoopCounter;
                 Frame.CallState = State::Loop;
                 break;
@@ -1515,6 +1785,7 @@ void Interpreter::algorithmResume() {
                 break;
               }
               case State::Exit:
+                LocalValues.resize(EvalFrameStack.back().ValuesBase);
                 CurEvalFrameStack.pop_back();
                 EvalFrameStack.pop_back();
                 LoopCounterStack.pop();
@@ -1588,6 +1859,9 @@ void Interpreter::algorithmResume() {
             return failBadState();
         }
         break;
+      case Method::EvalBytecode:
+        evalBytecode();
+        break;
       case Method::EvalInCallingContext:
         switch (Frame.CallState) {
           case State::Enter: {
@@ -1887,6 +2161,9 @@ void Interpreter::algorithmResume() {
         }
         break;
     }
+    // Note: Checked after dispatching, so that each call makes progress.
+    if (!takeStep())
+      break;
   }
 #if LOG_RUNMETHODS
   TRACE_BLOCK({ describeState(tracE.getFile()); });
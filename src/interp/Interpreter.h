@@ -20,6 +20,8 @@
 #ifndef DECOMPRESSOR_SRC_INTERP_INTERPRETER_H_
 #define DECOMPRESSOR_SRC_INTERP_INTERPRETER_H_
 
+#include <map>
+
 #include "interp/Interpreter-defs.h"
 #include "interp/InterpreterFlags.h"
 #include "stream/ValueFormat.h"
@@ -43,6 +45,7 @@ class TextWriter;
 namespace interp {
 
 class AlgorithmSelector;
+class Bytecode;
 class Interpreter;
 class Reader;
 class Writer;
@@ -81,10 +84,8 @@ class Interpreter {
   void setWriter(std::shared_ptr<Writer> Value);
 
   std::shared_ptr<filt::SymbolTable> getSymbolTable() { return Symtab; }
-  void setSymbolTable(std::shared_ptr<filt::SymbolTable> NewSymtab) {
-    Symtab = NewSymtab;
-  }
-  void resetSymbolTable() { Symtab.reset(); }
+  void setSymbolTable(std::shared_ptr<filt::SymbolTable> NewSymtab);
+  void resetSymbolTable();
 
   bool getFreezeEofAtExit() { return FreezeEofAtExit; }
   void setFreezeEofAtExit(bool NewValue) { FreezeEofAtExit = NewValue; }
@@ -103,6 +104,14 @@ class Interpreter {
   // Resume should be called until isFinished() is true.
   void algorithmResume();
 
+  // Limits the number of steps (i.e. methods dispatched, and bytecode
+  // instructions that read input) run by each call to algorithmResume().
+  // Zero implies no limit.
+  void setStepBudget(size_t NewValue) { StepBudget = NewValue; }
+  // True if the last call to algorithmResume() returned because its step
+  // budget was used up.
+  bool stepBudgetUsedUp() const { return StepBudgetUsedUp; }
+
   // Reads from backfilled input stream.
   void algorithmReadBackFilled();
 
@@ -194,27 +203,31 @@ class Interpreter {
     // exiting.  Note: For method write, this corresponds to the value
     // to write as well.
     decode::IntType ReturnValue;
+    // The bytecode (and program counter) of method EvalBytecode.
+    const Bytecode* Code;
+    size_t Pc;
   };
 
-  // The stack of calling "eval" expressions.
+  // The stack of calling "eval" expressions. Frames are stored by value,
+  // and their values (value parameters followed by locals) are allocated
+  // on LocalValues, starting at ValuesBase. Both are released when the eval
+  // returns, but keep their capacity (even across reset()).
   struct EvalFrame {
     EvalFrame();
     EvalFrame(const filt::Eval* Caller,
               const filt::DefineFrame* DefinedFrame,
-              size_t CallingEvalIndex);
-    EvalFrame& operator=(const EvalFrame& F);
-    EvalFrame(const EvalFrame& F);
+              size_t CallingEvalIndex,
+              size_t ValuesBase);
     bool isDefined() const;
     void reset();
-    decode::IntType getValueParam(size_t Index) const;
-    void setValueParam(size_t Index, decode::IntType Value);
-    decode::IntType getLocal(size_t Index) const;
-    void setLocal(size_t Index, decode::IntType Value);
-    void describe(FILE* File, filt::TextWriter* Writer) const;
+    size_t getNumValues() const;
+    void describe(FILE* File,
+                  filt::TextWriter* Writer,
+                  const decode::IntType* Values) const;
     const filt::Eval* Caller;
     const filt::DefineFrame* DefinedFrame;
     size_t CallingEvalIndex;
-    std::vector<decode::IntType> Values;
+    size_t ValuesBase;
   };
 
   std::shared_ptr<Reader> Input;
@@ -245,11 +258,19 @@ class Interpreter {
   // catches.
   bool IsFatalFailure;
   bool CheckForEof;
+  // True if reads might block, and hence input availability must be
+  // checked before reading (see Reader::isAllInputAvailable()).
+  bool CheckInputAvailable;
+  // The number of steps allowed in each call to algorithmResume() (0 implies
+  // no limit), and the number of steps left in the current call.
+  size_t StepBudget;
+  size_t StepsLeft;
+  bool StepBudgetUsedUp;
   // The stack of called methods.
   CallFrame Frame;
   utils::ValueStack<CallFrame> FrameStack;
   // The stack of (eval) calls.
-  std::vector<std::unique_ptr<EvalFrame>> EvalFrameStack;
+  std::vector<EvalFrame> EvalFrameStack;
   std::vector<size_t> CurEvalFrameStack;
   // The stack of loop counters.
   size_t LoopCounter;
@@ -277,6 +298,15 @@ class Interpreter {
   OpcodeLocalsFrame OpcodeLocals;
   utils::ValueStack<OpcodeLocalsFrame> OpcodeLocalsStack;
 
+  // The compiled bytecode of each (evaluated) definition, for each modifier.
+  std::map<std::pair<const filt::Node*, MethodModifier>,
+           std::unique_ptr<Bytecode>>
+      BytecodeCache;
+  // Buffers values of bulk loops (see opcode LoopValue) between being read
+  // and written.
+  std::vector<uint8_t> LoopBytes;
+  std::vector<uint32_t> LoopWords;
+
   const filt::Header* HeaderOverride;
   bool FreezeEofAtExit;
 
@@ -292,6 +322,35 @@ class Interpreter {
 
   void popAndReturn(decode::IntType Value = 0);
 
+  // Uses a step of the step budget. Returns false if the budget is used up.
+  bool takeStep() {
+    if (StepBudget == 0)
+      return true;
+    if (StepsLeft == 0) {
+      StepBudgetUsedUp = true;
+      return false;
+    }
+    --StepsLeft;
+    return true;
+  }
+
+  // Returns the bytecode to evaluate Nd with the given modifier, compiling
+  // it if not already compiled.
+  const Bytecode* getBytecode(const filt::Node* Nd, MethodModifier Modifier);
+  // Runs the bytecode of the current (EvalBytecode) frame, until it returns,
+  // needs more input, or calls another method.
+  void evalBytecode();
+  // Copies the remaining bytes of the input block to the output, stopping
+  // early if more input must be filled first. Bytes are copied directly
+  // (page by page) if both are byte streams. Returns false if unable to
+  // write.
+  bool copyBlockBytes();
+  // Reads up to Count values of Format, for opcode LoopValue. Updates Count
+  // to the number of values read. Returns false if unable to read.
+  bool readLoopValues(const filt::Node* Format, size_t& Count);
+  // Writes the (Count) values last read by readLoopValues().
+  bool writeLoopValues(const filt::Node* Format, size_t Count);
+
   EvalFrame* getCurrentEvalFrame();
 
   // For debugging only.
@@ -36,6 +36,9 @@ struct InterpreterFlags {
   bool TraceProgress;
   bool TraceIntermediateStreams;
   bool TraceAppliedAlgorithms;
+  // When true, algorithm definitions are compiled to (and evaluated as)
+  // bytecode, rather than walking the nodes of each definition.
+  bool UseBytecode;
 };
 
 }  // end of namespace interp
@@ -63,6 +63,12 @@ uint64_t ReadStream::readVaruint64(ReadCursor& Pos) {
   return fmt::readVaruint64(Pos);
 }
 
+void ReadStream::readVaruint32Array(ReadCursor& Pos,
+                                    uint32_t* Values,
+                                    size_t Count) {
+  fmt::readVaruint32Array(Pos, Values, Count);
+}
+
 }  // end of namespace interp
 
 }  // end of namespace wasm
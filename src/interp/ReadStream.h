@@ -51,6 +51,9 @@ class ReadStream : public std::enable_shared_from_this<ReadStream> {
   int64_t readVarint64(decode::ReadCursor& Pos);
   uint32_t readVaruint32(decode::ReadCursor& Pos);
   uint64_t readVaruint64(decode::ReadCursor& Pos);
+  void readVaruint32Array(decode::ReadCursor& Pos,
+                          uint32_t* Values,
+                          size_t Count);
 
   // Formatted reads
   virtual decode::IntType readValue(decode::ReadCursor& Pos,
@@ -18,6 +18,7 @@
 
 #include "interp/Reader.h"
 
+#include "interp/FormattedValue-templates.h"
 #include "sexp/Ast.h"
 #include "utils/Trace.h"
 
@@ -75,6 +76,10 @@ uint8_t Reader::readBit() {
   return readVaruint64() & 0x1;
 }
 
+ReadCursor* Reader::getBytePos() {
+  return nullptr;
+}
+
 uint8_t Reader::readUint8() {
   return uint8_t(readVaruint64());
 }
@@ -99,41 +104,29 @@ uint32_t Reader::readVaruint32() {
   return uint32_t(readVaruint64());
 }
 
+size_t Reader::readUint8Array(uint8_t* Values, size_t Count) {
+  size_t NumRead = 0;
+  do {
+    Values[NumRead++] = readUint8();
+  } while (NumRead < Count && stillMoreInputToProcessNow());
+  return NumRead;
+}
+
+size_t Reader::readVaruint32Array(uint32_t* Values, size_t Count) {
+  size_t NumRead = 0;
+  do {
+    Values[NumRead++] = readVaruint32();
+  } while (NumRead < Count && stillMoreInputToProcessNow());
+  return NumRead;
+}
+
 bool Reader::readBinary(const Node*, IntType& Value) {
   Value = readVaruint64();
   return true;
 }
 
 bool Reader::readValue(const filt::Node* Format, IntType& Value) {
-  switch (Format->getType()) {
-    case NodeType::Bit:
-      Value = readBit();
-      return true;
-    case NodeType::Uint8:
-      Value = readUint8();
-      return true;
-    case NodeType::Uint32:
-      Value = readUint32();
-      return true;
-    case NodeType::Uint64:
-      Value = readUint64();
-      return true;
-    case NodeType::Varint32:
-      Value = readVarint32();
-      return true;
-    case NodeType::Varint64:
-      Value = readVarint64();
-      return true;
-    case NodeType::Varuint32:
-      Value = readVaruint32();
-      return true;
-    case NodeType::Varuint64:
-      Value = readVaruint64();
-      return true;
-    default:
-      Value = 0;
-      return false;
-  }
+  return readFormattedValue(*this, Format, Value);
 }
 
 bool Reader::readHeaderValue(IntTypeFormat Format, IntType& Value) {
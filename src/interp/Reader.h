@@ -25,6 +25,10 @@
 
 namespace wasm {
 
+namespace decode {
+class ReadCursor;
+}  // end of namespace decode
+
 namespace filt {
 
 class Node;
@@ -53,6 +57,9 @@ class Reader : public std::enable_shared_from_this<Reader> {
   virtual void describePeekPosStack(FILE* Out) = 0;
   virtual bool canProcessMoreInputNow() = 0;
   virtual bool stillMoreInputToProcessNow() = 0;
+  // Returns true if all input is available, and hence reads can't block
+  // (i.e. stillMoreInputToProcessNow() need not be checked).
+  virtual bool isAllInputAvailable() { return false; }
   virtual bool atInputEof() = 0;
   virtual bool atInputEob() = 0;
   virtual bool pushPeekPos() = 0;
@@ -62,6 +69,10 @@ class Reader : public std::enable_shared_from_this<Reader> {
   virtual bool readAction(decode::IntType Action);
   virtual void readFillStart() = 0;
   virtual void readFillMoreInput() = 0;
+  // Returns the read cursor, if the input is a stream of (unencoded) bytes
+  // that can be copied directly (see Writer::getBytePos()). Otherwise
+  // returns nullptr.
+  virtual decode::ReadCursor* getBytePos();
   // Hard coded reads.
   virtual uint8_t readBit();
   virtual uint8_t readUint8();
@@ -71,6 +82,12 @@ class Reader : public std::enable_shared_from_this<Reader> {
   virtual int64_t readVarint64();
   virtual uint32_t readVaruint32();
   virtual uint64_t readVaruint64() = 0;
+  // Bulk reads, used to apply loops over a single value. Reads at most Count
+  // (> 0) values, and returns the number of values read. At least one value
+  // is read, but later values are only read if they are known to be
+  // available (see stillMoreInputToProcessNow()).
+  virtual size_t readUint8Array(uint8_t* Values, size_t Count);
+  virtual size_t readVaruint32Array(uint32_t* Values, size_t Count);
   virtual bool alignToByte();
   virtual bool readBlockEnter();
   virtual bool readBlockExit();
@@ -0,0 +1,427 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a decompressor that decompresses the sections of a WASM module
+// in parallel.
+
+#include "interp/SectionDecompressor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "stream/MappedFileQueue.h"
+#include "stream/RawStream.h"
+#include "stream/ReadBackedQueue.h"
+#include "stream/ReadCursor.h"
+#include "stream/StringWriter.h"
+#include "stream/WriteBackedQueue.h"
+
+namespace wasm {
+
+using namespace decode;
+
+namespace interp {
+
+namespace {
+
+constexpr size_t kHeaderSize = 8;
+// Magic number "\0asm", followed by (uint32) version 0xd.
+const uint8_t WasmHeader[kHeaderSize] = {0x00, 0x61, 0x73, 0x6d,
+                                         0x0d, 0x00, 0x00, 0x00};
+constexpr size_t kReadBufferSize = 4096;
+constexpr size_t kMaxVaruint32Size = 5;
+constexpr uint32_t kCodeSectionCode = 10;
+// Number of parts to split the sections into, for each job. Note: Each part
+// is decompressed using a separate interpreter. Hence, parts should not be
+// too small.
+constexpr size_t kPartsPerJob = 4;
+
+// Reads a varuint32 at Address (less than End) of Bytes. Returns false if
+// malformed.
+template <class Container>
+bool readVaruint32(const Container& Bytes,
+                   size_t& Address,
+                   size_t End,
+                   uint32_t& Value) {
+  Value = 0;
+  for (size_t i = 0; i < kMaxVaruint32Size; ++i) {
+    if (Address >= End)
+      return false;
+    uint8_t Byte = Bytes[Address++];
+    Value |= uint32_t(Byte & 0x7f) << (7 * i);
+    if ((Byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+// Appends Value to Bytes as a varuint32. If IsFixed, the (maximum) width used
+// for non-minimized block sizes is used.
+template <class Container>
+void writeVaruint32(Container& Bytes, uint32_t Value, bool IsFixed) {
+  for (size_t i = 1; i < kMaxVaruint32Size; ++i) {
+    if (!IsFixed && Value < 0x80)
+      break;
+    Bytes.push_back((Value & 0x7f) | 0x80);
+    Value >>= 7;
+  }
+  Bytes.push_back(Value & 0x7f);
+}
+
+// Reads a sequence of byte ranges as a single stream.
+class ExtentReader : public RawStream {
+  ExtentReader(const ExtentReader&) = delete;
+  ExtentReader& operator=(const ExtentReader&) = delete;
+
+ public:
+  ExtentReader() : CurIndex(0) {}
+  ~ExtentReader() OVERRIDE {}
+
+  void addExtent(const uint8_t* Begin, const uint8_t* End) {
+    if (Begin < End)
+      Extents.emplace_back(Begin, End);
+  }
+
+  AddressType read(ByteType* Buf, AddressType Size = 1) OVERRIDE {
+    AddressType Count = 0;
+    while (Count < Size && CurIndex < Extents.size()) {
+      std::pair<const uint8_t*, const uint8_t*>& Range = Extents[CurIndex];
+      size_t Chunk =
+          std::min(size_t(Size - Count), size_t(Range.second - Range.first));
+      memcpy(Buf + Count, Range.first, Chunk);
+      Count += Chunk;
+      Range.first += Chunk;
+      if (Range.first == Range.second)
+        ++CurIndex;
+    }
+    return Count;
+  }
+  bool write(ByteType*, AddressType) OVERRIDE { return false; }
+  bool freeze() OVERRIDE { return false; }
+  bool atEof() OVERRIDE { return CurIndex == Extents.size(); }
+  bool hasErrors() OVERRIDE { return false; }
+
+ private:
+  std::vector<std::pair<const uint8_t*, const uint8_t*>> Extents;
+  size_t CurIndex;
+};
+
+}  // end of anonymous namespace
+
+SectionDecompressor::SectionDecompressor(DecompressFcn Decompress,
+                                         size_t NumJobs)
+    : Decompress(Decompress),
+      NumJobs(NumJobs),
+      NumSections(0),
+      NumFunctionGroups(0),
+      Module(nullptr),
+      ModuleSize(0) {}
+
+SectionDecompressor::~SectionDecompressor() {}
+
+bool SectionDecompressor::hasWasmHeader(std::shared_ptr<Queue> Input) {
+  // Note: Start keeps the pages read in the queue, so that the input can
+  // still be decompressed from its beginning.
+  ReadCursor Start(StreamType::Byte, Input);
+  ReadCursor Pos(Start);
+  for (size_t i = 0; i < kHeaderSize; ++i) {
+    if (Pos.atEof() || Pos.readByte() != WasmHeader[i])
+      return false;
+  }
+  return true;
+}
+
+void SectionDecompressor::readModule(std::shared_ptr<Queue> Input) {
+  ModuleCopy.clear();
+  AddressType Address = 0;
+  uint8_t Buffer[kReadBufferSize];
+  while (AddressType Count = Input->read(Address, Buffer, kReadBufferSize))
+    ModuleCopy.insert(ModuleCopy.end(), Buffer, Buffer + Count);
+  Module = ModuleCopy.data();
+  ModuleSize = ModuleCopy.size();
+}
+
+bool SectionDecompressor::findSections() {
+  Parts.clear();
+  NumSections = 0;
+  NumFunctionGroups = 0;
+  if (ModuleSize < kHeaderSize ||
+      memcmp(Module, WasmHeader, kHeaderSize) != 0)
+    return false;
+  Parts.emplace_back(0, kHeaderSize);
+  // Group consecutive sections into parts of (roughly) the same size.
+  size_t PartSize = (ModuleSize - kHeaderSize) / (NumJobs * kPartsPerJob);
+  size_t Address = kHeaderSize;
+  size_t Begin = Address;
+  while (Address < ModuleSize) {
+    size_t SectionBegin = Address;
+    uint32_t Code;
+    uint32_t Size;
+    if (!readVaruint32(Module, Address, ModuleSize, Code) ||
+        !readVaruint32(Module, Address, ModuleSize, Size) ||
+        Size > ModuleSize - Address) {
+      Parts.clear();
+      NumSections = 0;
+      NumFunctionGroups = 0;
+      return false;
+    }
+    size_t BodyBegin = Address;
+    Address += Size;
+    ++NumSections;
+    if (Code == kCodeSectionCode && Size > PartSize) {
+      // Too big to be a single part. Split its function bodies instead.
+      if (Begin < SectionBegin)
+        Parts.emplace_back(Begin, SectionBegin);
+      if (!findFunctions(BodyBegin, Address, PartSize))
+        Parts.emplace_back(SectionBegin, Address);
+      Begin = Address;
+      continue;
+    }
+    if (Address - Begin >= PartSize || Address == ModuleSize) {
+      Parts.emplace_back(Begin, Address);
+      Begin = Address;
+    }
+  }
+  return true;
+}
+
+bool SectionDecompressor::findFunctions(size_t Address,
+                                        size_t End,
+                                        size_t PartSize) {
+  uint32_t NumFunctions;
+  if (!readVaruint32(Module, Address, End, NumFunctions) || NumFunctions < 2)
+    return false;
+  const size_t FirstGroup = Parts.size();
+  size_t Begin = Address;
+  uint32_t GroupSize = 0;
+  for (uint32_t i = 0; i < NumFunctions; ++i) {
+    uint32_t Size;
+    if (!readVaruint32(Module, Address, End, Size) || Size > End - Address) {
+      Parts.resize(FirstGroup, Extent(0, 0));
+      return false;
+    }
+    Address += Size;
+    ++GroupSize;
+    if (Address - Begin < PartSize && i + 1 < NumFunctions)
+      continue;
+    // Define a code section containing only the functions of the group.
+    Parts.emplace_back(Begin, Address);
+    std::vector<uint8_t>& Header = Parts.back().SectionHeader;
+    std::vector<uint8_t> Count;
+    writeVaruint32(Count, GroupSize, false);
+    writeVaruint32(Header, kCodeSectionCode, false);
+    writeVaruint32(Header, Count.size() + (Address - Begin), false);
+    Header.insert(Header.end(), Count.begin(), Count.end());
+    Begin = Address;
+    GroupSize = 0;
+  }
+  if (Address != End) {
+    Parts.resize(FirstGroup, Extent(0, 0));
+    return false;
+  }
+  Parts[FirstGroup].NumGroups = Parts.size() - FirstGroup;
+  Parts[FirstGroup].NumFunctions = NumFunctions;
+  NumFunctionGroups += Parts.size() - FirstGroup;
+  return true;
+}
+
+bool SectionDecompressor::decompressPart(size_t Index) {
+  // Read a module containing only the header and the sections of the part.
+  const uint8_t* Bytes = Module;
+  const Extent& Part = Parts[Index];
+  auto Reader = std::make_shared<ExtentReader>();
+  Reader->addExtent(Bytes, Bytes + kHeaderSize);
+  if (Index > 0) {
+    const std::vector<uint8_t>& SectionHeader = Part.SectionHeader;
+    Reader->addExtent(SectionHeader.data(),
+                      SectionHeader.data() + SectionHeader.size());
+    Reader->addExtent(Bytes + Part.Begin, Bytes + Part.End);
+  }
+  auto Input = std::make_shared<ReadBackedQueue>(Reader);
+  {
+    auto Output = std::make_shared<WriteBackedQueue>(
+        std::make_shared<StringWriter>(Outputs[Index]));
+    if (!Decompress(Input, Output))
+      return false;
+  }
+  if (Index == 0)
+    return true;
+  // Verify that the module header was decompressed the same, so that it can
+  // be removed.
+  const std::string& Header = Outputs[0];
+  std::string& Output = Outputs[Index];
+  if (Output.compare(0, Header.size(), Header) != 0)
+    return false;
+  Output.erase(0, Header.size());
+  return true;
+}
+
+bool SectionDecompressor::mergeFunctionGroups(size_t Index) {
+  // Each decompressed function group is a code section. Remove the section
+  // header from each, and prefix the merged function bodies with a header
+  // for the entire code section. Note: The section size must be recomputed,
+  // since the encoding may change the size of function bodies.
+  std::string SectionCode;
+  bool IsFixed = false;
+  size_t BodiesSize = 0;
+  const size_t NumGroups = Parts[Index].NumGroups;
+  for (size_t i = Index; i < Index + NumGroups; ++i) {
+    std::string& Output = Outputs[i];
+    size_t Address = 0;
+    uint32_t Code;
+    uint32_t SectionSize;
+    uint32_t Count;
+    if (!readVaruint32(Output, Address, Output.size(), Code))
+      return false;
+    const size_t SizeBegin = Address;
+    if (!readVaruint32(Output, Address, Output.size(), SectionSize))
+      return false;
+    if (i == Index) {
+      SectionCode = Output.substr(0, SizeBegin);
+      IsFixed = (Address - SizeBegin) == kMaxVaruint32Size;
+    }
+    const size_t CountBegin = Address;
+    if (!readVaruint32(Output, Address, Output.size(), Count) ||
+        SectionSize != Output.size() - CountBegin)
+      return false;
+    Output.erase(0, Address);
+    BodiesSize += Output.size();
+  }
+  std::string Count;
+  writeVaruint32(Count, Parts[Index].NumFunctions, false);
+  std::string Header(SectionCode);
+  writeVaruint32(Header, Count.size() + BodiesSize, IsFixed);
+  Header.append(Count);
+  Outputs[Index].insert(0, Header);
+  return true;
+}
+
+bool SectionDecompressor::decompressModule(std::shared_ptr<Queue> Input,
+                                           std::shared_ptr<RawStream> Output) {
+  Parts.clear();
+  NumSections = 0;
+  NumFunctionGroups = 0;
+  return Decompress(Input, std::make_shared<WriteBackedQueue>(Output));
+}
+
+bool SectionDecompressor::writeOutputs(size_t Begin,
+                                       size_t End,
+                                       std::shared_ptr<RawStream> Output) {
+  for (size_t i = Begin; i < End; ++i) {
+    std::string& Bytes = Outputs[i];
+    if (!Output->write((ByteType*)Bytes.data(), Bytes.size()))
+      return false;
+    // Note: The output of the header is kept, since it is used to verify
+    // each part.
+    if (i > 0)
+      std::string().swap(Bytes);
+  }
+  return true;
+}
+
+bool SectionDecompressor::decompressParts(std::shared_ptr<RawStream> Output) {
+  Outputs.clear();
+  Outputs.resize(Parts.size());
+  // Decompress the header first, since it is needed to verify the decompressed
+  // sections. Also creates the (shared) built-in symbol tables before any
+  // thread is started. Note: Decompressing the header doesn't use the
+  // opcode/section lookups of the algorithm. Sharing the symbol tables is
+  // safe because SymbolTable::install() builds all lookup tables up front, so
+  // the threads only read them.
+  if (!decompressPart(0) || !writeOutputs(0, 1, Output))
+    return false;
+  // Note: Parts are handed out in order, so that idle threads pick up the
+  // next undecompressed part, and parts are written (in order) as soon as
+  // they are done.
+  std::atomic<size_t> NextIndex(1);
+  std::mutex DoneMutex;
+  std::condition_variable DoneChanged;
+  std::vector<bool> Done(Parts.size(), false);
+  bool Succeeded = true;
+  auto RunJob = [&]() {
+    for (size_t Index = NextIndex++; Index < Parts.size();
+         Index = NextIndex++) {
+      bool Decompressed = decompressPart(Index);
+      std::lock_guard<std::mutex> Lock(DoneMutex);
+      Done[Index] = true;
+      if (!Decompressed)
+        Succeeded = false;
+      DoneChanged.notify_all();
+    }
+  };
+  std::vector<std::thread> Jobs;
+  size_t NumThreads = std::min(NumJobs, Parts.size() - 1);
+  for (size_t i = 0; i < NumThreads; ++i)
+    Jobs.emplace_back(RunJob);
+  // Write each part once it (and for code sections, all of its function
+  // groups) is done.
+  size_t Index = 1;
+  while (Index < Parts.size()) {
+    size_t End = Index + std::max(Parts[Index].NumGroups, size_t(1));
+    {
+      std::unique_lock<std::mutex> Lock(DoneMutex);
+      DoneChanged.wait(Lock, [&]() {
+        return !Succeeded ||
+               std::all_of(Done.begin() + Index, Done.begin() + End,
+                           [](bool IsDone) { return IsDone; });
+      });
+      if (!Succeeded)
+        break;
+    }
+    if ((Parts[Index].NumGroups > 0 && !mergeFunctionGroups(Index)) ||
+        !writeOutputs(Index, End, Output)) {
+      std::lock_guard<std::mutex> Lock(DoneMutex);
+      Succeeded = false;
+      break;
+    }
+    Index = End;
+  }
+  // Don't start any more parts if writing stopped early.
+  NextIndex = Parts.size();
+  for (std::thread& Job : Jobs)
+    Job.join();
+  return Succeeded && Output->freeze();
+}
+
+bool SectionDecompressor::decompress(std::shared_ptr<Queue> Input,
+                                     std::shared_ptr<RawStream> Output) {
+  if (NumJobs <= 1 || !hasWasmHeader(Input))
+    return decompressModule(Input, Output);
+  readModule(Input);
+  if (findSections() && Parts.size() > 2)
+    return decompressParts(Output);
+  // Note: Input has been read, so decompress the copy.
+  auto Reader = std::make_shared<ExtentReader>();
+  Reader->addExtent(Module, Module + ModuleSize);
+  return decompressModule(std::make_shared<ReadBackedQueue>(Reader), Output);
+}
+
+bool SectionDecompressor::decompress(std::shared_ptr<MappedFileQueue> Input,
+                                     std::shared_ptr<RawStream> Output) {
+  Module = Input->getMappedBase();
+  ModuleSize = Input->getMappedSize();
+  if (NumJobs > 1 && findSections() && Parts.size() > 2)
+    return decompressParts(Output);
+  return decompressModule(Input, Output);
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
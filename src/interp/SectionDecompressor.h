@@ -0,0 +1,139 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a decompressor that decompresses the sections of a WASM module
+// in parallel.
+//
+// Each section of a WASM module is size prefixed. Hence, once the extent of
+// each section is known, it can be decompressed independently (as a module
+// containing only that section). The decompressed sections are then
+// concatenated in order.
+//
+// Since the code section is typically most of the module, and each function
+// body within it is also size prefixed, large code sections are further split
+// into groups of function bodies. Each group is decompressed as a module
+// containing a code section with only those functions, and the section header
+// (i.e. size and function count) is recomputed when the groups are stitched
+// back together.
+//
+// Only (uncompressed) WASM 0xd modules are split. Any other input, including
+// compressed (casm/cism) files, can't be split without first decoding it, and
+// hence is streamed through a single decompressor, using a single thread.
+//
+// When split, the bytes of the module are read directly if the input is a
+// memory-mapped file, and copied otherwise. Decompressed parts are written
+// (in order) as soon as they, and all parts before them, are done.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_SECTIONDECOMPRESSOR_H_
+#define DECOMPRESSOR_SRC_INTERP_SECTIONDECOMPRESSOR_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utils/Defs.h"
+
+namespace wasm {
+
+namespace decode {
+class MappedFileQueue;
+class Queue;
+class RawStream;
+}  // end of namespace decode
+
+namespace interp {
+
+class SectionDecompressor {
+  SectionDecompressor() = delete;
+  SectionDecompressor(const SectionDecompressor&) = delete;
+  SectionDecompressor& operator=(const SectionDecompressor&) = delete;
+
+ public:
+  // Decompresses (all of) Input into Output, returning true if successful.
+  // Note: Called concurrently, once for each section.
+  typedef std::function<bool(std::shared_ptr<decode::Queue> Input,
+                             std::shared_ptr<decode::Queue> Output)>
+      DecompressFcn;
+
+  SectionDecompressor(DecompressFcn Decompress, size_t NumJobs);
+  ~SectionDecompressor();
+
+  // Decompresses Input into Output, using up to NumJobs threads. If Input
+  // isn't a WASM module, it is decompressed as is (i.e. sequentially).
+  // Returns true if successful.
+  bool decompress(std::shared_ptr<decode::Queue> Input,
+                  std::shared_ptr<decode::RawStream> Output);
+  // Same as above, except that the module is read directly from the mapped
+  // file, rather than copied.
+  bool decompress(std::shared_ptr<decode::MappedFileQueue> Input,
+                  std::shared_ptr<decode::RawStream> Output);
+
+  // Returns the number of sections decompressed in parallel.
+  size_t getNumSections() const { return NumSections; }
+
+  // Returns the number of function groups the code section was split into.
+  size_t getNumFunctionGroups() const { return NumFunctionGroups; }
+
+ private:
+  struct Extent {
+    size_t Begin;
+    size_t End;
+    // Synthesized code section header to prepend to a group of function
+    // bodies. Empty if the extent is a group of sections.
+    std::vector<uint8_t> SectionHeader;
+    // For the first function group of a code section, the number of function
+    // groups, and the total number of functions, in the code section.
+    size_t NumGroups;
+    uint32_t NumFunctions;
+    Extent(size_t Begin, size_t End)
+        : Begin(Begin), End(End), NumGroups(0), NumFunctions(0) {}
+    bool isFunctionGroup() const { return !SectionHeader.empty(); }
+  };
+  DecompressFcn Decompress;
+  size_t NumJobs;
+  size_t NumSections;
+  size_t NumFunctionGroups;
+  // The bytes of the module to decompress. Either the mapped input file, or
+  // a copy (in ModuleCopy) of the input.
+  const uint8_t* Module;
+  size_t ModuleSize;
+  std::vector<uint8_t> ModuleCopy;
+  // The module header, followed by the extent of each group of (consecutive)
+  // sections, or code section function bodies, to decompress as a unit.
+  std::vector<Extent> Parts;
+  // The decompressed output for each part. Released once written.
+  std::vector<std::string> Outputs;
+
+  static bool hasWasmHeader(std::shared_ptr<decode::Queue> Input);
+  void readModule(std::shared_ptr<decode::Queue> Input);
+  bool findSections();
+  bool findFunctions(size_t Address, size_t End, size_t PartSize);
+  bool decompressPart(size_t Index);
+  bool mergeFunctionGroups(size_t Index);
+  bool decompressModule(std::shared_ptr<decode::Queue> Input,
+                        std::shared_ptr<decode::RawStream> Output);
+  bool decompressParts(std::shared_ptr<decode::RawStream> Output);
+  bool writeOutputs(size_t Begin,
+                    size_t End,
+                    std::shared_ptr<decode::RawStream> Output);
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_SECTIONDECOMPRESSOR_H_
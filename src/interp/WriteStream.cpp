@@ -70,6 +70,12 @@ void WriteStream::writeFixedVaruint32(uint32_t Value, WriteCursor& Pos) {
   fmt::writeFixedVaruint32(Value, Pos);
 }
 
+void WriteStream::writeVaruint32Array(const uint32_t* Values,
+                                      size_t Count,
+                                      WriteCursor& Pos) {
+  fmt::writeVaruint32Array(Values, Count, Pos);
+}
+
 }  // end of namespace decode
 
 }  // end of namespace wasm
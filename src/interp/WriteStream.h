@@ -56,6 +56,9 @@ class WriteStream : public std::enable_shared_from_this<WriteStream> {
   void writeVaruint32(uint32_t Value, decode::WriteCursor& Pos);
   void writeVaruint64(uint64_t Value, decode::WriteCursor& Pos);
   void writeFixedVaruint32(uint32_t Value, decode::WriteCursor& Pos);
+  void writeVaruint32Array(const uint32_t* Values,
+                           size_t Count,
+                           decode::WriteCursor& Pos);
   virtual bool writeAction(decode::WriteCursor& Pos,
                            const filt::CallbackNode* Action) = 0;
 
@@ -72,6 +75,10 @@ class WriteStream : public std::enable_shared_from_this<WriteStream> {
   virtual void writeVarintBlockSize(decode::WriteCursor& Pos,
                                     size_t BlockSIze) = 0;
 
+  // Returns the number of elements (stream specific) writeVarintBlockSize()
+  // uses to write BlockSize.
+  virtual size_t getVarintBlockSizeWidth(size_t BlockSize) = 0;
+
   // Returns the size of the block, defined by the range of the
   // passed positions (specific to the stream).
   virtual size_t getBlockSize(decode::WriteCursor& StartPos,
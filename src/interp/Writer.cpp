@@ -17,6 +17,8 @@
 // implements a writer for wasm/casm files.
 
 #include "interp/Writer.h"
+
+#include "interp/FormattedValue-templates.h"
 #include "sexp/Ast.h"
 #include "utils/Trace.h"
 
@@ -34,6 +36,19 @@ bool Writer::writeBit(uint8_t Value) {
   return writeVaruint64(Value & 0x1);
 }
 
+bool Writer::writeBits(uint32_t Value, unsigned Count) {
+  while (Count > 0) {
+    --Count;
+    if (!writeBit(uint8_t((Value >> Count) & 0x1)))
+      return false;
+  }
+  return true;
+}
+
+WriteCursor* Writer::getBytePos() {
+  return nullptr;
+}
+
 bool Writer::writeUint8(uint8_t Value) {
   return writeVaruint64(Value);
 }
@@ -58,6 +73,20 @@ bool Writer::writeVaruint32(uint32_t Value) {
   return writeVaruint64(Value);
 }
 
+bool Writer::writeUint8Array(const uint8_t* Values, size_t Count) {
+  for (size_t i = 0; i < Count; ++i)
+    if (!writeUint8(Values[i]))
+      return false;
+  return true;
+}
+
+bool Writer::writeVaruint32Array(const uint32_t* Values, size_t Count) {
+  for (size_t i = 0; i < Count; ++i)
+    if (!writeVaruint32(Values[i]))
+      return false;
+  return true;
+}
+
 void Writer::setMinimizeBlockSize(bool NewValue) {
   MinimizeBlockSize = NewValue;
 }
@@ -122,36 +151,7 @@ bool Writer::writeTypedValue(IntType Value, IntTypeFormat Format) {
 }
 
 bool Writer::writeValue(decode::IntType Value, const filt::Node* Format) {
-  // Note: We pass through virtual functions to force any applicable cast
-  // conversions.
-  switch (Format->getType()) {
-    case NodeType::Bit:
-      writeBit(Value);
-      return true;
-    case NodeType::Uint8:
-      writeUint8(Value);
-      return true;
-    case NodeType::Uint32:
-      writeUint32(Value);
-      return true;
-    case NodeType::Uint64:
-      writeUint64(Value);
-      return true;
-    case NodeType::Varint32:
-      writeVarint32(Value);
-      return true;
-    case NodeType::Varint64:
-      writeVarint64(Value);
-      return true;
-    case NodeType::Varuint32:
-      writeVaruint32(Value);
-      return true;
-    case NodeType::Varuint64:
-      writeVaruint64(Value);
-      return true;
-    default:
-      return false;
-  }
+  return writeFormattedValue(*this, Value, Format);
 }
 
 bool Writer::writeBlockEnter() {
@@ -24,6 +24,10 @@
 
 namespace wasm {
 
+namespace decode {
+class WriteCursor;
+}  // end of namespace decode
+
 namespace filt {
 class SymbolNode;
 }  // end of namespace filt
@@ -41,9 +45,16 @@ class Writer {
 
   virtual void reset();
   virtual decode::StreamType getStreamType() const = 0;
+  // Returns the write cursor, if the output is a stream of (unencoded) bytes
+  // that can be written directly (see Reader::getBytePos()). Otherwise
+  // returns nullptr.
+  virtual decode::WriteCursor* getBytePos();
   // Override the following as needed. These methods return false if the writes
   // failed. Default actions are to do nothing and return true.
   virtual bool writeBit(uint8_t Value);
+  // Writes the low Count (at most 32) bits of Value, most significant bit
+  // first. Default writes each bit using writeBit().
+  virtual bool writeBits(uint32_t Value, unsigned Count);
   virtual bool writeUint8(uint8_t Value);
   virtual bool writeUint32(uint32_t Value);
   virtual bool writeUint64(uint64_t Value);
@@ -51,6 +62,10 @@ class Writer {
   virtual bool writeVarint64(int64_t Value);
   virtual bool writeVaruint32(uint32_t Value);
   virtual bool writeVaruint64(uint64_t Value) = 0;
+  // Bulk writes, used to apply loops over a single value. Default writes each
+  // value separately.
+  virtual bool writeUint8Array(const uint8_t* Values, size_t Count);
+  virtual bool writeVaruint32Array(const uint32_t* Values, size_t Count);
   virtual bool alignToByte();
   virtual bool writeBlockEnter();
   virtual bool writeBlockExit();
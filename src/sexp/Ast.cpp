@@ -457,23 +457,10 @@ bool Cached::implementsClass(NodeType Type) {
 }
 
 IntLookup::IntLookup(SymbolTable& Symtab)
-    : Cached(Symtab, NodeType::IntLookup) {}
+    : Cached(Symtab, NodeType::IntLookup), Lookup(nullptr) {}
 
 IntLookup::~IntLookup() {}
 
-const Node* IntLookup::get(decode::IntType Value) {
-  if (Lookup.count(Value))
-    return Lookup[Value];
-  return nullptr;
-}
-
-bool IntLookup::add(decode::IntType Value, const Node* Nd) {
-  if (Lookup.count(Value))
-    return false;
-  Lookup[Value] = Nd;
-  return true;
-}
-
 SymbolDefn::SymbolDefn(SymbolTable& Symtab)
     : Cached(Symtab, NodeType::SymbolDefn),
       ForSymbol(nullptr),
@@ -626,6 +613,7 @@ SymbolTable::SymbolTable() {
 }
 
 void SymbolTable::init() {
+  CacheGeneration = 0;
   Alg = nullptr;
   setAlgorithm(nullptr);
   NextCreationIndex = 0;
@@ -917,6 +905,7 @@ void SymbolTable::clearCaches() {
     Alg->clearCaches();
   IsAlgInstalled = false;
   CachedValue.clear();
+  ++CacheGeneration;
   UndefinedCallbacks.clear();
   CallbackValues.clear();
   CallbackLiterals.clear();
@@ -1089,9 +1078,36 @@ bool SymbolTable::install() {
     IsValid = areActionsConsistent();
   if (!IsValid)
     fatal("Unable to install algorthms, validation failed!");
+  installLookups();
   return IsAlgInstalled = true;
 }
 
+void SymbolTable::installLookups() {
+  getSourceHeader();
+  getReadHeader();
+  getWriteHeader();
+  // Note: Looking up (enclosing) definitions may create symbols, so collect
+  // the symbols first.
+  std::vector<const Symbol*> Symbols;
+  Symbols.reserve(SymbolMap.size());
+  for (const auto& Pair : SymbolMap)
+    Symbols.push_back(Pair.second);
+  for (const Symbol* Sym : Symbols) {
+    const SymbolDefn* Defn = getSymbolDefn(Sym);
+    Defn->getDefineDefinition();
+    Defn->getLiteralDefinition();
+    Defn->getLiteralActionDefinition();
+  }
+  for (const auto& Pair : CachedValue) {
+    if (const auto* Lookup = dyn_cast<IntLookup>(Pair.second))
+      Lookup->build();
+  }
+  for (const Node* Nd : Allocated) {
+    if (const auto* Eval = dyn_cast<BinaryEval>(Nd))
+      Eval->installDecodeTables();
+  }
+}
+
 const Header* SymbolTable::getSourceHeader() const {
   if (CachedSourceHeader != nullptr)
     return CachedSourceHeader;
@@ -2381,14 +2397,17 @@ bool SelectBase::implementsClass(NodeType Type) {
 }
 
 SelectBase::SelectBase(SymbolTable& Symtab, NodeType Type)
-    : Nary(Symtab, Type) {}
+    : Nary(Symtab, Type), Lookup(nullptr), LookupGeneration(0) {}
 
 IntLookup* SelectBase::getIntLookup() const {
-  IntLookup* Lookup = cast<IntLookup>(Symtab.getCachedValue(this));
+  if (Lookup != nullptr && LookupGeneration == Symtab.getCacheGeneration())
+    return Lookup;
+  Lookup = cast<IntLookup>(Symtab.getCachedValue(this));
   if (Lookup == nullptr) {
     Lookup = Symtab.create<IntLookup>();
     Symtab.setCachedValue(this, Lookup);
   }
+  LookupGeneration = Symtab.getCacheGeneration();
   return Lookup;
 }
 
@@ -2716,6 +2735,64 @@ bool BinaryEval::addEncoding(const BinaryAccept* Encoding) const {
   return getIntLookup()->add(Encoding->getValue(), Encoding);
 }
 
+namespace {
+
+// Maximum number of bits decoded by a single decode table.
+constexpr unsigned kMaxDecodeBits = 10;
+
+unsigned getBinaryDepth(const Node* Nd) {
+  if (!isa<BinarySelect>(Nd))
+    return 0;
+  return 1 + std::max(getBinaryDepth(Nd->getKid(0)),
+                      getBinaryDepth(Nd->getKid(1)));
+}
+
+}  // end of anonymous namespace
+
+const BinaryEval::DecodeTable* BinaryEval::getDecodeTable() const {
+  if (DecodeTables.empty())
+    return buildDecodeTable(getKid(0));
+  return DecodeTables.front().get();
+}
+
+void BinaryEval::installDecodeTables() const {
+  DecodeTables.clear();
+  buildDecodeTable(getKid(0));
+}
+
+const BinaryEval::DecodeTable* BinaryEval::buildDecodeTable(
+    const Node* Root) const {
+  DecodeTables.push_back(utils::make_unique<DecodeTable>());
+  DecodeTable* Table = DecodeTables.back().get();
+  Table->Root = Root;
+  Table->NumBits = std::min(kMaxDecodeBits, getBinaryDepth(Root));
+  Table->Entries.resize(size_t(1) << Table->NumBits);
+  fillDecodeTable(Table, Root, 0, 0);
+  return Table;
+}
+
+void BinaryEval::fillDecodeTable(DecodeTable* Table,
+                                 const Node* Nd,
+                                 unsigned Depth,
+                                 size_t Prefix) const {
+  if (isa<BinarySelect>(Nd) && Depth < Table->NumBits) {
+    fillDecodeTable(Table, Nd->getKid(0), Depth + 1, Prefix << 1);
+    fillDecodeTable(Table, Nd->getKid(1), Depth + 1, (Prefix << 1) | 1);
+    return;
+  }
+  // Path ends (or leaves the table) at Nd. Install for all indices with the
+  // given prefix.
+  DecodeEntry Entry;
+  Entry.Nd = Nd;
+  Entry.Next = isa<BinarySelect>(Nd) ? buildDecodeTable(Nd) : nullptr;
+  Entry.NumBits = Depth;
+  unsigned Unused = Table->NumBits - Depth;
+  size_t First = Prefix << Unused;
+  size_t Last = First + (size_t(1) << Unused);
+  for (size_t i = First; i < Last; ++i)
+    Table->Entries[i] = Entry;
+}
+
 }  // end of namespace filt
 
 }  // end of namespace wasm
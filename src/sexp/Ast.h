@@ -30,6 +30,7 @@
 #include "sexp/NodeType.h"
 #include "sexp/PredefinedStrings-defs.h"
 #include "stream/ValueFormat.h"
+#include "utils/DenseIntMap.h"
 
 namespace wasm {
 
@@ -218,8 +219,16 @@ class SymbolTable FINAL : public std::enable_shared_from_this<SymbolTable> {
   BinaryAccept* createBinaryAccept(decode::IntType Value, unsigned NumBits);
 
   // Returns the cached value associated with a node, or nullptr if not cached.
-  Node* getCachedValue(const Node* Nd) { return CachedValue[Nd]; }
+  // Note: Doesn't add an entry for Nd, so that lookups don't modify an
+  // installed symbol table.
+  Node* getCachedValue(const Node* Nd) const {
+    auto Pos = CachedValue.find(Nd);
+    return Pos == CachedValue.end() ? nullptr : Pos->second;
+  }
   void setCachedValue(const Node* Nd, Node* Value) { CachedValue[Nd] = Value; }
+  // Incremented each time cached values are cleared. Allows nodes to keep
+  // a (local) copy of a cached value.
+  uint32_t getCacheGeneration() const { return CacheGeneration; }
 
   // Adds the given callback literal to the set of known callback literals.
   void insertCallbackLiteral(const LiteralActionDef* Defn);
@@ -270,6 +279,7 @@ class SymbolTable FINAL : public std::enable_shared_from_this<SymbolTable> {
   Callback* BlockEnterCallback;
   Callback* BlockExitCallback;
   CachedValueMap CachedValue;
+  uint32_t CacheGeneration;
   mutable const Header* CachedSourceHeader;
   mutable const Header* CachedReadHeader;
   mutable const Header* CachedWriteHeader;
@@ -282,6 +292,10 @@ class SymbolTable FINAL : public std::enable_shared_from_this<SymbolTable> {
   bool standardizeAlgorithm();
   void installPredefined();
   void installDefinitions(const Node* Root);
+  // Builds the lookup tables that are otherwise built on first use. Once
+  // installed, the symbol table is then only read, and can be shared by
+  // interpreters running on separate threads.
+  void installLookups();
 
   bool areActionsConsistent();
   Node* stripUsing(Node* Root, std::function<Node*(Node*)> stripKid);
@@ -577,11 +591,18 @@ class IntLookup FINAL : public Cached {
   IntLookup& operator=(const IntLookup&) = delete;
 
  public:
-  typedef std::unordered_map<decode::IntType, const Node*> LookupMap;
+  typedef utils::DenseIntMap<decode::IntType, const Node*> LookupMap;
   explicit IntLookup(SymbolTable&);
   ~IntLookup() OVERRIDE;
-  const Node* get(decode::IntType Value);
-  bool add(decode::IntType Value, const Node* Nd);
+  const Node* get(decode::IntType Value) const { return Lookup.get(Value); }
+  bool add(decode::IntType Value, const Node* Nd) {
+    return Lookup.add(Value, Nd);
+  }
+  // Builds the lookup array now, rather than on the first lookup.
+  void build() const { Lookup.build(); }
+  static bool implementsClass(NodeType Type) {
+    return Type == NodeType::IntLookup;
+  }
 
  private:
   LookupMap Lookup;
@@ -824,6 +845,12 @@ class SelectBase : public Nary {
  protected:
   SelectBase(SymbolTable& Symtab, NodeType Type);
   IntLookup* getIntLookup() const;
+
+ private:
+  // Local copy of the (cached) case lookup, to avoid searching the cached
+  // values of the symbol table on each selection.
+  mutable IntLookup* Lookup;
+  mutable uint32_t LookupGeneration;
 };
 
 #define X(NAME, BASE, DECLS, INIT)               \
@@ -912,12 +939,39 @@ class BinaryEval : public Unary {
   const Node* getEncoding(decode::IntType Value) const;
   bool addEncoding(const BinaryAccept* Encoding) const;
 
+  // Tables used to decode several bits of the encoding at a time. Entries
+  // are indexed by the next NumBits bits to read (the first bit read being
+  // the most significant bit of the index).
+  struct DecodeTable;
+  struct DecodeEntry {
+    // The node reached after reading NumBits bits. If Next is non-null, the
+    // path continues using (secondary) table Next.
+    const Node* Nd;
+    const DecodeTable* Next;
+    unsigned NumBits;
+  };
+  struct DecodeTable {
+    // The subtree of the encoding decoded by the table.
+    const Node* Root;
+    unsigned NumBits;
+    std::vector<DecodeEntry> Entries;
+  };
+  const DecodeTable* getDecodeTable() const;
+  // (Re)builds the decode tables now, rather than on first use.
+  void installDecodeTables() const;
+
   static bool implementsClass(NodeType Type) {
     return NodeType::BinaryEval == Type;
   }
 
  private:
+  mutable std::vector<std::unique_ptr<DecodeTable>> DecodeTables;
   IntLookup* getIntLookup() const;
+  const DecodeTable* buildDecodeTable(const Node* Root) const;
+  void fillDecodeTable(DecodeTable* Table,
+                       const Node* Nd,
+                       unsigned Depth,
+                       size_t Prefix) const;
 };
 
 }  // end of namespace filt
@@ -30,6 +30,19 @@ namespace {
 constexpr BitReadCursor::WordType BitsInByte =
     BitReadCursor::WordType(sizeof(ByteType) * CHAR_BIT);
 
+constexpr BitReadCursor::WordType BitsInWord =
+    BitReadCursor::WordType(sizeof(BitReadCursor::WordType) * CHAR_BIT);
+
+constexpr AddressType BytesInWord = sizeof(BitReadCursor::WordType);
+
+// Loads (big-endian) the word starting at Buffer.
+inline BitReadCursor::WordType loadWord(const ByteType* Buffer) {
+  return (BitReadCursor::WordType(Buffer[0]) << 24) |
+         (BitReadCursor::WordType(Buffer[1]) << 16) |
+         (BitReadCursor::WordType(Buffer[2]) << 8) |
+         BitReadCursor::WordType(Buffer[3]);
+}
+
 }  // end of namespace
 
 BitReadCursor::BitReadCursor() {
@@ -128,9 +141,18 @@ bool BitReadCursor::atEob() {
   return NumBits == 0;
 }
 
+size_t BitReadCursor::getContiguousBytesAvailable() {
+  // Bytes can only be read directly if byte aligned.
+  if (NumBits > 0)
+    return 0;
+  return ReadCursor::getContiguousBytesAvailable();
+}
+
 ByteType BitReadCursor::readByte() {
   if (NumBits == 0)
     return ReadCursor::readByte();
+  if (CurAddress + BytesInWord <= GuaranteedBeforeEob)
+    return ByteType(readBits(BitsInByte));
   BITREAD(ByteMask, BitsInByte);
 }
 
@@ -138,6 +160,52 @@ ByteType BitReadCursor::readBit() {
   BITREAD(1, 1);
 }
 
+BitReadCursor::WordType BitReadCursor::readBits(unsigned Count) {
+  assert(Count <= BitsInWord);
+  if (Count <= NumBits) {
+    NumBits -= Count;
+    WordType Value = CurWord >> NumBits;
+    CurWord &= (WordType(1) << NumBits) - 1;
+    return Value;
+  }
+  // Only load a word at a time if it lies within the current page, and
+  // before the end of the enclosing block. Otherwise, fall back to reading
+  // a byte at a time (which handles page and block boundaries).
+  if (CurAddress + BytesInWord > GuaranteedBeforeEob)
+    return readBitsSlow(Count);
+  // Note: Only the bytes needed to supply Count bits are consumed, so that
+  // (as with readBit) less than a byte of bits remain in CurWord.
+  unsigned NumBytes = (Count - NumBits + BitsInByte - 1) / BitsInByte;
+  uint64_t Bits = (uint64_t(CurWord) << BitsInWord) | loadWord(getBufferPtr());
+  Bits >>= BitsInWord - NumBytes * BitsInByte;
+  CurAddress += NumBytes;
+  NumBits += NumBytes * BitsInByte - Count;
+  CurWord = WordType(Bits) & ((WordType(1) << NumBits) - 1);
+  return WordType(Bits >> NumBits);
+}
+
+bool BitReadCursor::peekBits(unsigned Count, WordType& Value) {
+  assert(Count <= BitsInWord);
+  if (Count <= NumBits) {
+    Value = CurWord >> (NumBits - Count);
+    return true;
+  }
+  if (CurAddress + BytesInWord > GuaranteedBeforeEob)
+    return false;
+  uint64_t Bits = (uint64_t(CurWord) << BitsInWord) | loadWord(getBufferPtr());
+  Value = WordType(Bits >> (NumBits + BitsInWord - Count));
+  return true;
+}
+
+BitReadCursor::WordType BitReadCursor::readBitsSlow(unsigned Count) {
+  WordType Value = 0;
+  for (; Count >= BitsInByte; Count -= BitsInByte)
+    Value = (Value << BitsInByte) | BitReadCursor::readByte();
+  for (; Count > 0; --Count)
+    Value = (Value << 1) | BitReadCursor::readBit();
+  return Value;
+}
+
 }  // end of namespace decode
 
 }  // end of namespace wasm
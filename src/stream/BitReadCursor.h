@@ -46,8 +46,15 @@ class BitReadCursor : public ReadCursor {
   void swap(BitReadCursor& C);
 
   bool atEob() OVERRIDE;
+  size_t getContiguousBytesAvailable() OVERRIDE;
   ByteType readByte() OVERRIDE;
   ByteType readBit() OVERRIDE;
+  // Reads the next Count (at most 32) bits, most significant bit first.
+  WordType readBits(unsigned Count);
+  // Sets Value to the next Count (at most 32) bits, without consuming
+  // them. Returns false (and does nothing) if the bits are not all within
+  // the current page and block.
+  bool peekBits(unsigned Count, WordType& Value);
   void alignToByte();
 
   void describeDerivedExtensions(FILE* File, bool IncludeDetail) OVERRIDE;
@@ -57,6 +64,7 @@ class BitReadCursor : public ReadCursor {
   unsigned NumBits;
 
   void initFields();
+  WordType readBitsSlow(unsigned Count);
 };
 
 }  // end of namespace decode
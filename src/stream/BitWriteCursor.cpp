@@ -28,6 +28,9 @@ namespace {
 constexpr BitWriteCursor::WordType BitsInByte =
     BitWriteCursor::WordType(sizeof(ByteType) * CHAR_BIT);
 
+constexpr BitWriteCursor::WordType BitsInWord =
+    BitWriteCursor::WordType(sizeof(BitWriteCursor::WordType) * CHAR_BIT);
+
 }  // end of namespace
 
 BitWriteCursor::BitWriteCursor() {
@@ -63,6 +66,13 @@ bool BitWriteCursor::atEof() const {
   return NumBits == 0;
 }
 
+size_t BitWriteCursor::getContiguousBytesAvailable() {
+  // Bytes can only be written directly if byte aligned.
+  if (NumBits > 0)
+    return 0;
+  return WriteCursor::getContiguousBytesAvailable();
+}
+
 void BitWriteCursor::assign(const BitWriteCursor& C) {
   WriteCursor::assign(C);
   CurWord = C.CurWord;
@@ -94,6 +104,30 @@ void BitWriteCursor::writeBit(ByteType Bit) {
   }
 }
 
+void BitWriteCursor::writeBits(WordType Value, unsigned Count) {
+  assert(Count <= BitsInWord);
+  if (Count == 0)
+    return;
+  // Accumulate (in 64 bits) the pending bits, followed by Value. Then flush
+  // whole bytes, leaving less than a byte of bits in CurWord.
+  uint64_t Bits = (uint64_t(CurWord) << Count) |
+                  (uint64_t(Value) & ((uint64_t(1) << Count) - 1));
+  NumBits += Count;
+  unsigned NumBytes = NumBits / BitsInByte;
+  NumBits -= NumBytes * BitsInByte;
+  if (CurAddress + NumBytes <= GuaranteedBeforeEob) {
+    // Fast path: All bytes fit within the current page (and block).
+    ByteType* Buffer = getBufferPtr();
+    for (unsigned i = 0; i < NumBytes; ++i)
+      Buffer[i] = ByteType(Bits >> (NumBits + (NumBytes - i - 1) * BitsInByte));
+    CurAddress += NumBytes;
+  } else {
+    for (unsigned i = NumBytes; i > 0; --i)
+      WriteCursor::writeByte(ByteType(Bits >> (NumBits + (i - 1) * BitsInByte)));
+  }
+  CurWord = WordType(Bits) & ((WordType(1) << NumBits) - 1);
+}
+
 void BitWriteCursor::alignToByte() {
   if (NumBits == 0)
     return;
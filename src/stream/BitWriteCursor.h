@@ -36,10 +36,14 @@ class BitWriteCursor : public WriteCursor {
   BitWriteCursor(const BitWriteCursor& C, AddressType StartAddress);
   ~BitWriteCursor() OVERRIDE;
   bool atEof() const OVERRIDE;
+  size_t getContiguousBytesAvailable() OVERRIDE;
   void assign(const BitWriteCursor& C);
   void swap(BitWriteCursor& C);
   void writeByte(ByteType Byte) OVERRIDE;
   void writeBit(ByteType Bit) OVERRIDE;
+  // Writes the low Count (at most 32) bits of Value, most significant bit
+  // first.
+  void writeBits(WordType Value, unsigned Count);
   void alignToByte();
 
   BitWriteCursor& operator=(const BitWriteCursor& C) {
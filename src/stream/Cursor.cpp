@@ -30,7 +30,7 @@ Cursor::TraceContext::TraceContext(Cursor& Pos) : Pos(Pos) {}
 Cursor::TraceContext::~TraceContext() {}
 
 Cursor::Cursor(StreamType Type, std::shared_ptr<Queue> Que)
-    : PageCursor(Que->FirstPage, Que->FirstPage->getMinAddress()),
+    : PageCursor(PagePtr(Que->FirstPage), Que->FirstPage->getMinAddress()),
       Type(Type),
       Que(Que),
       EobPtr(Que->getEofPtr()) {
@@ -131,6 +131,11 @@ void Cursor::close() {
   GuaranteedBeforeEob = false;
 }
 
+size_t Cursor::getContiguousBytesAvailable() {
+  return CurAddress < GuaranteedBeforeEob ? GuaranteedBeforeEob - CurAddress
+                                          : 0;
+}
+
 void Cursor::updateGuaranteedBeforeEob() {
   GuaranteedBeforeEob =
       CurPage ? std::min(CurPage->getMaxAddress(), EobPtr->getEobAddress()) : 0;
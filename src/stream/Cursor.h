@@ -62,6 +62,18 @@ class Cursor : public PageCursor {
   AddressType fillSize();
   AddressType getAddress() const { return CurAddress; }
 
+  // Returns the number of bytes that can be read/written directly in the
+  // page buffer (i.e. starting at getBufferPtr()), without crossing the end
+  // of the current page or the enclosing block. Used by fast paths that
+  // process several bytes at once.
+  virtual size_t getContiguousBytesAvailable();
+
+  // Moves past Size bytes, where Size <= getContiguousBytesAvailable().
+  void consumeContiguousBytes(size_t Size) {
+    assert(CurAddress + Size <= GuaranteedBeforeEob);
+    CurAddress += Size;
+  }
+
   // For debugging.
   FILE* describe(FILE* File, bool IncludeDetail = false, bool AddEoln = false);
   // Adds any extentions to the page address, as defined in a derived class.
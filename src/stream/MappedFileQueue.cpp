@@ -0,0 +1,100 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "stream/MappedFileQueue.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "stream/Page.h"
+
+namespace wasm {
+
+namespace decode {
+
+MappedFileQueue::MappedFileQueue(const char* Filename)
+    : MappedBase(nullptr), MappedSize(0), FoundErrors(true) {
+  int Fd = open(Filename, O_RDONLY);
+  if (Fd < 0)
+    return;
+  struct stat Stat;
+  if (fstat(Fd, &Stat) == 0 && S_ISREG(Stat.st_mode) &&
+      AddressType(Stat.st_size) <= kMaxEofAddress) {
+    MappedSize = AddressType(Stat.st_size);
+    if (MappedSize == 0) {
+      FoundErrors = false;
+    } else {
+      void* Base = mmap(nullptr, MappedSize, PROT_READ, MAP_PRIVATE, Fd, 0);
+      if (Base != MAP_FAILED) {
+        MappedBase = static_cast<ByteType*>(Base);
+        FoundErrors = false;
+      } else {
+        MappedSize = 0;
+      }
+    }
+  }
+  // Note: The mapping remains valid after the file descriptor is closed.
+  ::close(Fd);
+  if (MappedBase == nullptr)
+    return;
+  // Replace the (buffer allocated) initial page with one that aliases the
+  // mapped file.
+  initPages(createPage(0));
+}
+
+MappedFileQueue::~MappedFileQueue() {
+  // NOTE: Pages must be released before the memory they alias is unmapped.
+  close();
+  if (MappedBase != nullptr)
+    munmap(MappedBase, MappedSize);
+}
+
+PagePtr MappedFileQueue::createPage(AddressType PageIndex) {
+  AddressType MinAddress = minAddressForPage(PageIndex);
+  if (MinAddress >= MappedSize)
+    return Queue::createPage(PageIndex);
+  return PagePtr(new Page(PageIndex, MappedBase + MinAddress));
+}
+
+bool MappedFileQueue::readFill(AddressType Address) {
+  // Double check that there isn't more to read.
+  if (Address < LastPage->getMaxAddress())
+    return true;
+  if (EofFrozen)
+    return false;
+  while (Address >= LastPage->getMaxAddress()) {
+    // Create new page if current page full.
+    if (LastPage->spaceRemaining() == 0 && !appendPage())
+      return false;
+    // Note: All bytes of the page are made available at once.
+    AddressType MaxAddress =
+        std::min(LastPage->getMinAddress() + PageSize, MappedSize);
+    if (MaxAddress <= LastPage->getMaxAddress()) {
+      AddressType EofAddress = LastPage->getMaxAddress();
+      freezeEof(EofAddress);
+      return false;
+    }
+    LastPage->setMaxAddress(MaxAddress);
+  }
+  return true;
+}
+
+}  // end of decode namespace
+
+}  // end of wasm namespace
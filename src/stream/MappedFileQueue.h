@@ -0,0 +1,62 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Defines a read-only queue whose pages alias a memory-mapped file. Unlike
+// ReadBackedQueue, no bytes are copied (and no page buffers are allocated)
+// to make the contents of the file available to readers.
+
+#ifndef DECOMPRESSOR_SRC_STREAM_MAPPEDFILEQUEUE_H_
+#define DECOMPRESSOR_SRC_STREAM_MAPPEDFILEQUEUE_H_
+
+#include "stream/Queue.h"
+
+namespace wasm {
+
+namespace decode {
+
+class MappedFileQueue FINAL : public Queue {
+  MappedFileQueue(const MappedFileQueue&) = delete;
+  MappedFileQueue& operator=(const MappedFileQueue&) = delete;
+  MappedFileQueue() = delete;
+
+ public:
+  MappedFileQueue(const char* Filename);
+  ~MappedFileQueue() OVERRIDE;
+
+  // Returns true if the file could not be mapped. Callers should fall back
+  // to a ReadBackedQueue (e.g. when reading from a pipe).
+  bool hasErrors() const { return FoundErrors; }
+
+  // Returns the mapped contents of the file (nullptr if empty), so that
+  // callers can read it directly.
+  const ByteType* getMappedBase() const { return MappedBase; }
+  AddressType getMappedSize() const { return MappedSize; }
+
+ private:
+  ByteType* MappedBase;
+  AddressType MappedSize;
+  bool FoundErrors;
+
+  bool readFill(AddressType Address) OVERRIDE;
+  PagePtr createPage(AddressType PageIndex) OVERRIDE;
+};
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_STREAM_MAPPEDFILEQUEUE_H_
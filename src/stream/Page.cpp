@@ -22,10 +22,29 @@ namespace wasm {
 namespace decode {
 
 Page::Page(AddressType PageIndex)
-    : Index(PageIndex),
+    : Buffer(new ByteType[PageSize]),
+      OwnedBuffer(Buffer),
+      Index(PageIndex),
       MinAddress(minAddressForPage(PageIndex)),
-      MaxAddress(minAddressForPage(PageIndex)) {
-  std::memset(&Buffer, 0, PageSize);
+      MaxAddress(minAddressForPage(PageIndex)),
+      PinCount(0) {
+  std::memset(Buffer, 0, PageSize);
+}
+
+Page::Page(AddressType PageIndex, ByteType* Contents)
+    : Buffer(Contents),
+      Index(PageIndex),
+      MinAddress(minAddressForPage(PageIndex)),
+      MaxAddress(minAddressForPage(PageIndex)),
+      PinCount(0) {
+  assert(Contents != nullptr);
+}
+
+void Page::reset(AddressType PageIndex) {
+  assert(ownsBuffer());
+  Index = PageIndex;
+  MinAddress = MaxAddress = minAddressForPage(PageIndex);
+  std::memset(Buffer, 0, PageSize);
 }
 
 AddressType Page::spaceRemaining() const {
@@ -17,12 +17,12 @@
 // Defines a generic base class for pages (of values). It is used to model
 // streams in the WASM decompressor.
 //
-// Only shared pointers are used with pages. This guarantees that the
-// implementation of a queue (in streams/Queue.h) can figure out what
-// pages are no longer used.
+// Only pinning pointers (see class PagePtr) are used with pages. This
+// guarantees that the implementation of a queue (in streams/Queue.h) can
+// figure out what pages are no longer used.
 //
 // Note: If you need to "backpatch" an address, be sure to store a
-// shared pointer to that backpatch address, so that the page doesn't
+// pinning pointer to that backpatch address, so that the page doesn't
 // accidentally get garbage collected.
 //
 // Note: Virtual addresses are used, start at index 0, and correspond to a
@@ -31,7 +31,7 @@
 // the value you must always use address N.
 //
 // It is assumed that jumping on reads and writes are valid. However,
-// back jumps are only safe if you maintain a shared pointer to the
+// back jumps are only safe if you maintain a pinning pointer to the
 // address before returning to that address.
 //
 // The memory for buffers are divided into pages. This is done so that
@@ -41,8 +41,10 @@
 // to that simple masking can be used to compute the page index and
 // the byte address within the page.
 //
-// TODO(karlschimpf) The current implementation is NOT thread safe, but should
-// be easy to make thread safe.
+// Pages (and their pin counts) are NOT thread safe. A page belongs to the
+// queue that created it, and must only be used on the thread using that
+// queue (see Queue.h). Hence, pin counts are not atomic, and copying a cursor
+// (and hence its page pointer) is a plain integer increment.
 
 #ifndef DECOMPRESSOR_SRC_STREAM_PAGE_H_
 #define DECOMPRESSOR_SRC_STREAM_PAGE_H_
@@ -55,14 +57,19 @@ namespace decode {
 
 class Queue;
 
-class Page : public std::enable_shared_from_this<Page> {
+class Page {
   Page() = delete;
   Page(const Page&) = delete;
   Page& operator=(const Page&) = delete;
+  friend class PagePtr;
   friend class Queue;
 
  public:
   Page(AddressType PageIndex);
+  // Creates a page whose contents alias the (externally owned) memory
+  // Contents. The caller must guarantee that Contents outlives the page, and
+  // holds at least PageSize bytes (or up to eof if the last page).
+  Page(AddressType PageIndex, ByteType* Contents);
   AddressType spaceRemaining() const;
   AddressType getPageIndex() const { return Index; }
   AddressType getMinAddress() const { return MinAddress; }
@@ -80,13 +87,80 @@ class Page : public std::enable_shared_from_this<Page> {
 
  private:
   // The contents of the page.
-  ByteType Buffer[PageSize];
+  ByteType* Buffer;
+  // Memory holding the contents, if owned by the page. Null if the page
+  // aliases external memory.
+  std::unique_ptr<ByteType[]> OwnedBuffer;
   // The page index of the page.
   AddressType Index;
   // Note: Buffer address range is [MinAddress, MaxAddress).
   AddressType MinAddress;
   AddressType MaxAddress;
-  std::shared_ptr<Page> Next;
+  // Number of page pointers referring to this page.
+  size_t PinCount;
+
+  // Returns true if the page owns (and hence can recycle) its contents.
+  bool ownsBuffer() const { return bool(OwnedBuffer); }
+  // Reinitializes a recycled page so that it can be reused for PageIndex.
+  void reset(AddressType PageIndex);
+};
+
+// Pointer to a page that pins the page (i.e. keeps it alive) while it
+// refers to it. The page is deleted when the last pin is removed.
+class PagePtr {
+ public:
+  PagePtr() : Pg(nullptr) {}
+  explicit PagePtr(Page* Pg) : Pg(Pg) { pin(); }
+  PagePtr(const PagePtr& P) : Pg(P.Pg) { pin(); }
+  PagePtr(PagePtr&& P) : Pg(P.Pg) { P.Pg = nullptr; }
+  ~PagePtr() { unpin(); }
+
+  PagePtr& operator=(const PagePtr& P) {
+    Page* Old = Pg;
+    Pg = P.Pg;
+    pin();
+    release(Old);
+    return *this;
+  }
+
+  PagePtr& operator=(PagePtr&& P) {
+    if (this != &P) {
+      unpin();
+      Pg = P.Pg;
+      P.Pg = nullptr;
+    }
+    return *this;
+  }
+
+  Page* get() const { return Pg; }
+  Page* operator->() const { return Pg; }
+  Page& operator*() const { return *Pg; }
+  explicit operator bool() const { return Pg != nullptr; }
+  bool operator==(const PagePtr& P) const { return Pg == P.Pg; }
+  bool operator!=(const PagePtr& P) const { return Pg != P.Pg; }
+
+  // Returns true if this is the only pointer pinning the page.
+  bool isUnique() const { return Pg && Pg->PinCount == 1; }
+
+  void reset() {
+    unpin();
+    Pg = nullptr;
+  }
+
+  void swap(PagePtr& P) { std::swap(Pg, P.Pg); }
+
+ private:
+  Page* Pg;
+
+  void pin() {
+    if (Pg)
+      ++Pg->PinCount;
+  }
+  void unpin() { release(Pg); }
+  static void release(Page* P) {
+    if (P && --P->PinCount == 0)
+      delete P;
+  }
 };
 
 void describePage(FILE* File, Page* Pg);
@@ -30,7 +30,7 @@ PageCursor::PageCursor(Queue* Que)
   assert(CurPage);
 }
 
-PageCursor::PageCursor(std::shared_ptr<Page> CurPage, AddressType CurAddress)
+PageCursor::PageCursor(PagePtr CurPage, AddressType CurAddress)
     : CurPage(CurPage), CurAddress(CurAddress) {
   assert(CurPage);
 }
@@ -48,7 +48,7 @@ void PageCursor::assign(const PageCursor& C) {
 }
 
 void PageCursor::swap(PageCursor& C) {
-  std::swap(CurPage, C.CurPage);
+  CurPage.swap(C.CurPage);
   std::swap(CurAddress, C.CurAddress);
 }
 
@@ -17,12 +17,12 @@
 // Defines a generic base class for pages (of values). It is used to model
 // streams in the WASM decompressor.
 //
-// Only shared pointers are used with pages. This guarantees that the
-// implementation of a queue (in streams/Queue.h) can figure out what
-// pages are no longer used.
+// Only pinning pointers (see class PagePtr) are used with pages. This
+// guarantees that the implementation of a queue (in streams/Queue.h) can
+// figure out what pages are no longer used.
 //
 // Note: If you need to "backpatch" an address, be sure to store a
-// shared pointer to that backpatch address, so that the page doesn't
+// pinning pointer to that backpatch address, so that the page doesn't
 // accidentally get garbage collected.
 //
 // Note: Virtual addresses are used, start at index 0, and correspond to a
@@ -31,7 +31,7 @@
 // the value you must always use address N.
 //
 // It is assumed that jumping on reads and writes are valid. However,
-// back jumps are only safe if you maintain a shared pointer to the
+// back jumps are only safe if you maintain a pinning pointer to the
 // address before returning to that address.
 //
 // The memory for buffers are divided into pages. This is done so that
@@ -47,13 +47,12 @@
 #ifndef DECOMPRESSOR_SRC_STREAM_PAGECURSOR_H_
 #define DECOMPRESSOR_SRC_STREAM_PAGECURSOR_H_
 
-#include "stream/PageAddress.h"
+#include "stream/Page.h"
 
 namespace wasm {
 
 namespace decode {
 
-class Page;
 class Queue;
 
 class PageCursor {
@@ -63,7 +62,7 @@ class PageCursor {
  public:
   PageCursor();
   PageCursor(Queue* Que);
-  PageCursor(std::shared_ptr<Page> CurPage, AddressType CurAddress);
+  PageCursor(PagePtr CurPage, AddressType CurAddress);
   PageCursor(const PageCursor& PC);
   ~PageCursor();
   void assign(const PageCursor& C);
@@ -83,7 +82,7 @@ class PageCursor {
   FILE* describe(FILE* File, bool IncludePage = false);
 
  protected:
-  std::shared_ptr<Page> CurPage;
+  PagePtr CurPage;
   // Absolute address.
   AddressType CurAddress;
 };
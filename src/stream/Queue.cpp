@@ -29,11 +29,62 @@ Queue::Queue()
     : MinPeekSize(32),
       EofFrozen(false),
       Status(StatusValue::Good),
-      EofPtr(std::make_shared<BlockEob>()) {
+      EofPtr(std::make_shared<BlockEob>()),
+      FirstPage(nullptr),
+      RingFirstIndex(0),
+      RingStart(0),
+      RingCount(0),
+      MaxFreePages(4),
+      NumPagesAllocated(1),
+      NumPagesReused(0) {
   // Verify we have space for kErrorPageAddress and kUndefinedAddress.
   assert(PageSizeLog2 > 1);
-  LastPage = FirstPage = std::make_shared<Page>(0);
-  PageMap.push_back(LastPage);
+  initPages(PagePtr(new Page(0)));
+}
+
+void Queue::initPages(PagePtr Pg) {
+  PageRing.clear();
+  RingStart = 0;
+  RingCount = 0;
+  FirstPage = nullptr;
+  LastPage = Pg;
+  pushRingPage(std::move(Pg));
+}
+
+void Queue::pushRingPage(PagePtr Pg) {
+  if (RingCount == PageRing.size()) {
+    // Grow the ring, moving the first page to slot 0.
+    PageRingType NewRing(std::max(PageRing.size() * 2, size_t(8)));
+    for (size_t i = 0; i < RingCount; ++i)
+      NewRing[i] = std::move(PageRing[(RingStart + i) & (PageRing.size() - 1)]);
+    PageRing.swap(NewRing);
+    RingStart = 0;
+  }
+  if (RingCount == 0) {
+    RingFirstIndex = Pg->getPageIndex();
+    FirstPage = Pg.get();
+  }
+  assert(Pg->getPageIndex() == RingFirstIndex + RingCount);
+  PageRing[(RingStart + RingCount) & (PageRing.size() - 1)] = std::move(Pg);
+  ++RingCount;
+}
+
+PagePtr Queue::popFirstRingPage() {
+  assert(RingCount > 0);
+  PagePtr Pg = std::move(PageRing[RingStart]);
+  RingStart = (RingStart + 1) & (PageRing.size() - 1);
+  ++RingFirstIndex;
+  --RingCount;
+  FirstPage = RingCount ? PageRing[RingStart].get() : nullptr;
+  return Pg;
+}
+
+void Queue::popLastRingPage() {
+  assert(RingCount > 0);
+  --RingCount;
+  PageRing[(RingStart + RingCount) & (PageRing.size() - 1)].reset();
+  if (RingCount == 0)
+    FirstPage = nullptr;
 }
 
 void Queue::close() {
@@ -49,6 +100,12 @@ Queue::~Queue() {
   close();
 }
 
+void Queue::setMaxFreePages(size_t NewValue) {
+  MaxFreePages = NewValue;
+  if (FreePages.size() > MaxFreePages)
+    FreePages.resize(MaxFreePages);
+}
+
 AddressType Queue::currentSize() const {
   return EofPtr->getEobAddress();
 }
@@ -67,20 +124,20 @@ AddressType Queue::getEofAddress() const {
 
 void Queue::describe(FILE* Out) {
   fprintf(Out, "**** Queue %p ***\n", (void*)this);
-  fprintf(Out, "First = %p, Last = %p\n", (void*)FirstPage.get(),
+  fprintf(Out, "First = %p, Last = %p\n", (void*)FirstPage,
           (void*)LastPage.get());
-  for (AddressType i = 0; i < PageMap.size(); ++i) {
-    std::shared_ptr<Page> Pg = PageMap[i].lock();
-    if (Pg)
-      Pg->describe(Out);
-    else
-      fprintf(Out, "Page[%" PRIuMAX "] = nullptr", uintmax_t(i));
+  for (AddressType i = 0; i < RingCount; ++i) {
+    getRingPage(RingFirstIndex + i)->describe(Out);
     fprintf(Out, "\n");
   }
   if (ErrorPage) {
     fputs("Error ", Out);
     ErrorPage->describe(Out);
   }
+  fprintf(Out, "Pages allocated = %" PRIuMAX ", reused = %" PRIuMAX
+               ", free = %" PRIuMAX "\n",
+          uintmax_t(NumPagesAllocated), uintmax_t(NumPagesReused),
+          uintmax_t(FreePages.size()));
   fprintf(Out, "*****************\n");
 }
 
@@ -89,44 +146,44 @@ void Queue::fail() {
   EofPtr->setEobAddress(0);
 }
 
-std::shared_ptr<Page> Queue::getErrorPage() {
-  if (ErrorPage)
-    return ErrorPage;
-  ErrorPage = std::make_shared<Page>(kErrorPageIndex);
+PagePtr Queue::getErrorPage() {
+  if (!ErrorPage)
+    ErrorPage = PagePtr(new Page(kErrorPageIndex));
   return ErrorPage;
 }
 
-std::shared_ptr<Page> Queue::getReadPage(AddressType& Address) const {
+PagePtr Queue::getReadPage(AddressType& Address) const {
   AddressType Index = PageIndex(Address);
-  if (Index >= PageMap.size())
+  if (Index > LastPage->getPageIndex())
     return const_cast<Queue*>(this)->readFillToPage(Index, Address);
   return getDefinedPage(Index, Address);
 }
 
-std::shared_ptr<Page> Queue::getWritePage(AddressType& Address) const {
+PagePtr Queue::getWritePage(AddressType& Address) const {
   AddressType Index = PageIndex(Address);
-  if (Index >= PageMap.size())
+  if (Index > LastPage->getPageIndex())
     return const_cast<Queue*>(this)->writeFillToPage(Index, Address);
   return getDefinedPage(Index, Address);
 }
 
-std::shared_ptr<Page> Queue::getCachedPage(AddressType& Address) {
+PagePtr Queue::getCachedPage(AddressType& Address) {
   AddressType Index = PageIndex(Address);
-  if (Index >= PageMap.size())
+  if (Index > LastPage->getPageIndex())
     return failThenGetErrorPage(Address);
   return getDefinedPage(Index, Address);
 }
 
-std::shared_ptr<Page> Queue::getDefinedPage(AddressType Index,
-                                            AddressType& Address) const {
-  assert(Index < PageMap.size());
-  std::shared_ptr<Page> Pg = PageMap[Index].lock();
-  if (Pg)
-    return Pg;
+PagePtr Queue::getDefinedPage(AddressType Index, AddressType& Address) const {
+  assert(Index <= LastPage->getPageIndex());
+  if (Page* Pg = getRingPage(Index))
+    return PagePtr(Pg);
+  // Note: The last page is kept even after all pages have been dumped.
+  if (Index == LastPage->getPageIndex())
+    return LastPage;
   return const_cast<Queue*>(this)->failThenGetErrorPage(Address);
 }
 
-std::shared_ptr<Page> Queue::failThenGetErrorPage(AddressType& Address) {
+PagePtr Queue::failThenGetErrorPage(AddressType& Address) {
   fail();
   Address = kErrorPageAddress;
   return getErrorPage();
@@ -136,19 +193,37 @@ bool Queue::appendPage() {
   AddressType NewPageIndex = LastPage->getPageIndex() + 1;
   if (NewPageIndex > kMaxPageIndex)
     return false;
-  std::shared_ptr<Page> NewPage = std::make_shared<Page>(NewPageIndex);
-  PageMap.push_back(NewPage);
-  LastPage->Next = NewPage;
+  PagePtr NewPage = createPage(NewPageIndex);
   LastPage = NewPage;
+  pushRingPage(std::move(NewPage));
   return true;
 }
 
+PagePtr Queue::createPage(AddressType PageIndex) {
+  if (FreePages.empty()) {
+    ++NumPagesAllocated;
+    return PagePtr(new Page(PageIndex));
+  }
+  PagePtr Pg = std::move(FreePages.back());
+  FreePages.pop_back();
+  Pg->reset(PageIndex);
+  ++NumPagesReused;
+  return Pg;
+}
+
+void Queue::recyclePage(PagePtr& Pg) {
+  if (!Pg.isUnique() || !Pg->ownsBuffer() || FreePages.size() >= MaxFreePages)
+    return;
+  FreePages.push_back(std::move(Pg));
+}
+
 void Queue::dumpFirstPage() {
-  FirstPage = FirstPage->Next;
+  PagePtr Pg = popFirstRingPage();
+  recyclePage(Pg);
 }
 
 void Queue::dumpPreviousPages() {
-  while (FirstPage.unique())
+  while (RingCount > 0 && PageRing[RingStart].isUnique())
     dumpFirstPage();
 }
 
@@ -174,8 +249,7 @@ bool Queue::writeFill(AddressType Address, AddressType WantedSize) {
   return true;
 }
 
-std::shared_ptr<Page> Queue::readFillToPage(AddressType Index,
-                                            AddressType& Address) {
+PagePtr Queue::readFillToPage(AddressType Index, AddressType& Address) {
   while (Index > LastPage->Index) {
     bool ReadFillNextPage = readFill(LastPage->getMinAddress() + PageSize);
     if (!ReadFillNextPage && Index > LastPage->Index) {
@@ -190,8 +264,7 @@ std::shared_ptr<Page> Queue::readFillToPage(AddressType Index,
   return getDefinedPage(Index, Address);
 }
 
-std::shared_ptr<Page> Queue::writeFillToPage(AddressType Index,
-                                             AddressType& Address) {
+PagePtr Queue::writeFillToPage(AddressType Index, AddressType& Address) {
   while (Index > LastPage->Index) {
     bool WriteFillNextPage = writeFill(LastPage->getMinAddress(), PageSize);
     if (!WriteFillNextPage && Index > LastPage->Index) {
@@ -215,6 +288,9 @@ AddressType Queue::readFromPage(AddressType& Address,
   // Find page associated with Address.
   Cursor.CurPage = getCachedPage(Address);
   Cursor.setCurAddress(Address);
+  // Note: Fails if the page has already been dumped.
+  if (isBroken(Cursor))
+    return 0;
   dumpPreviousPages();
   // Compute largest contiguous range of elements available.
   if (Address + WantedSize > Cursor.getMaxAddress())
@@ -230,6 +306,8 @@ AddressType Queue::writeToPage(AddressType& Address,
     return 0;
   Cursor.CurPage = getCachedPage(Address);
   Cursor.setCurAddress(Address);
+  if (isBroken(Cursor))
+    return 0;
   dumpPreviousPages();
   // Compute largest contiguous range of bytes available.
   if (Address + WantedSize > Cursor.getMaxAddress())
@@ -253,8 +331,9 @@ void Queue::freezeEof(AddressType& Address) {
     // TODO(karlschimpf): If adding threads, make this update thread safe.
     // If any pages exist after Cursor, remove them.
     LastPage = Cursor.CurPage;
-    if (Cursor.CurPage->Next)
-      Cursor.CurPage->Next.reset();
+    while (RingCount > 0 &&
+           RingFirstIndex + RingCount - 1 > LastPage->getPageIndex())
+      popLastRingPage();
   }
 }
 
@@ -274,6 +353,7 @@ AddressType Queue::read(AddressType& Address,
       return Count;
     uint8_t* FromBuf = Cursor.getBufferPtr();
     memcpy(ToBuf, FromBuf, FoundSize);
+    ToBuf += FoundSize;
     Count += FoundSize;
     WantedSize -= FoundSize;
     Address += FoundSize;
@@ -282,7 +362,7 @@ AddressType Queue::read(AddressType& Address,
 }
 
 bool Queue::write(AddressType& Address,
-                  uint8_t* FromBuf,
+                  const uint8_t* FromBuf,
                   AddressType WantedSize) {
   PageCursor Cursor(this);
   while (WantedSize) {
@@ -291,6 +371,7 @@ bool Queue::write(AddressType& Address,
       return false;
     uint8_t* ToBuf = Cursor.getBufferPtr();
     memcpy(ToBuf, FromBuf, FoundSize);
+    FromBuf += FoundSize;
     Address += FoundSize;
     WantedSize -= FoundSize;
   }
@@ -16,9 +16,12 @@
 
 // Defines a queue for hold buffers to streams.
 //
-// Shared pointers to pages are used to effectively lock pages in the buffer.
-// This allows one to "backpatch" addresses, making sure that the pages are not
-// thrown away until all shared pointers have been released.
+// Pinning pointers to pages (see PagePtr) are used to effectively lock pages in
+// the buffer. This allows one to "backpatch" addresses, making sure that the
+// pages are not thrown away until all pinning pointers have been released.
+//
+// Pages in the queue are kept in a ring of page slots, indexed by page index,
+// so that looking up the page for an address is simple integer arithmetic.
 //
 // Note: Virtual addresses are used, start at index 0, and correspond to a
 // buffer index as if the queue keeps all pages (i.e. doesn't shrink) until the
@@ -29,22 +32,24 @@
 // are only safe if you already have a cursor pointing to the page to be
 // backpatched.
 //
-// TODO(KarlSchimpf): Locking of reads/writes for threading has not yet been
-// addressed, and the current implementation is NOT thread safe.
+// Note: Queues are NOT thread safe. A queue (including its pages, pin counts,
+// and cursors) must never be shared across threads. It may only be handed to
+// another thread when the threads synchronize (i.e. thread start and join),
+// as is done for the output of the final stage of a pipeline. Concurrently
+// running threads must pass data using other means (see interp/IntPipe.h).
 
 #ifndef DECOMPRESSOR_SRC_STREAM_QUEUE_H_
 #define DECOMPRESSOR_SRC_STREAM_QUEUE_H_
 
 #include <vector>
 
-#include "stream/PageAddress.h"
+#include "stream/Page.h"
 
 namespace wasm {
 
 namespace decode {
 
 class BlockEob;
-class Page;
 class PageCursor;
 
 class Queue : public std::enable_shared_from_this<Queue> {
@@ -66,6 +71,14 @@ class Queue : public std::enable_shared_from_this<Queue> {
   // freezing an address. Defaults to 32.
   void setMinPeekSize(AddressType NewValue) { MinPeekSize = NewValue; }
 
+  // Defines the maximum number of dumped pages kept for reuse, rather than
+  // freeing them and allocating new pages. Defaults to 4.
+  void setMaxFreePages(size_t NewValue);
+
+  // Returns the number of pages allocated (resp. reused) by the queue.
+  size_t getNumPagesAllocated() const { return NumPagesAllocated; }
+  size_t getNumPagesReused() const { return NumPagesReused; }
+
   // Value unknown (returning maximum possible size) until frozen. When
   // frozen, returns the size of the buffer.
   AddressType currentSize() const;
@@ -123,7 +136,9 @@ class Queue : public std::enable_shared_from_this<Queue> {
   // @param Buffer  A pointer to the buffer of elements to write.
   // @param Size    The number of elements in the buffer to write.
   // @result        True if successful (i.e. not beyond eob address).
-  bool write(AddressType& Address, uint8_t* Buffer, AddressType Size = 1);
+  bool write(AddressType& Address,
+             const uint8_t* Buffer,
+             AddressType Size = 1);
 
   // Freezes eob of the queue. Not valid to read/write past the eob, once set.
   // Note: May change Address if queue is broken, or Address not valid.
@@ -141,7 +156,8 @@ class Queue : public std::enable_shared_from_this<Queue> {
   void describe(FILE* Out);
 
  protected:
-  typedef std::vector<std::weak_ptr<Page>> PageMapType;
+  typedef std::vector<PagePtr> PageRingType;
+  typedef std::vector<PagePtr> FreePagesType;
   // Minimum peek size to maintain. That is, the minimal number of
   // bytes that the read can back up without freezing an address.
   AddressType MinPeekSize;
@@ -149,32 +165,64 @@ class Queue : public std::enable_shared_from_this<Queue> {
   bool EofFrozen;
   StatusValue Status;
   std::shared_ptr<BlockEob> EofPtr;
-  // First page still in queue.
-  std::shared_ptr<Page> FirstPage;
+  // First page still in queue (nullptr once all pages have been dumped).
+  Page* FirstPage;
   // Page at the current end of buffer.
-  std::shared_ptr<Page> LastPage;
+  PagePtr LastPage;
   // Page to use if an error occurs.
-  std::shared_ptr<Page> ErrorPage;
-  // Fast page lookup map (from page index)
-  PageMapType PageMap;
+  PagePtr ErrorPage;
+  // Ring of page slots holding pages [FirstPage..LastPage]. The size of the
+  // ring is always a power of 2.
+  PageRingType PageRing;
+  // Page index of the page in slot RingStart.
+  AddressType RingFirstIndex;
+  size_t RingStart;
+  size_t RingCount;
+  // Dumped pages that can be reused by createPage().
+  FreePagesType FreePages;
+  size_t MaxFreePages;
+  size_t NumPagesAllocated;
+  size_t NumPagesReused;
+
+  // Replaces all pages in the queue with the (single) page Pg.
+  void initPages(PagePtr Pg);
 
   bool appendPage();
 
+  // Creates the page for the given page index, when appended to the
+  // queue. Derived classes can override to control where page contents live.
+  virtual PagePtr createPage(AddressType PageIndex);
+
+  // Adds the dumped page to the free list, if no longer referenced and there
+  // is room.
+  void recyclePage(PagePtr& Pg);
+
+  // Returns the page in the ring with the given page index, or nullptr if
+  // not in the queue.
+  Page* getRingPage(AddressType Index) const {
+    // Note: Wraps to a large value if Index < RingFirstIndex.
+    AddressType Offset = Index - RingFirstIndex;
+    if (Offset >= RingCount)
+      return nullptr;
+    return PageRing[(RingStart + Offset) & (PageRing.size() - 1)].get();
+  }
+  void pushRingPage(PagePtr Pg);
+  PagePtr popFirstRingPage();
+  void popLastRingPage();
+
   // Returns the page in the queue referred to Address, or nullptr if no
   // such page is in the byte queue.
-  std::shared_ptr<Page> getReadPage(AddressType& Address) const;
-  std::shared_ptr<Page> getWritePage(AddressType& Address) const;
-  std::shared_ptr<Page> getCachedPage(AddressType& Address);
-  std::shared_ptr<Page> getDefinedPage(AddressType Index,
-                                       AddressType& Address) const;
-  std::shared_ptr<Page> failThenGetErrorPage(AddressType& Address);
-  std::shared_ptr<Page> getErrorPage();
-  std::shared_ptr<Page> readFillToPage(AddressType Index, AddressType& Address);
-  std::shared_ptr<Page> writeFillToPage(AddressType Index,
-                                        AddressType& Address);
+  PagePtr getReadPage(AddressType& Address) const;
+  PagePtr getWritePage(AddressType& Address) const;
+  PagePtr getCachedPage(AddressType& Address);
+  PagePtr getDefinedPage(AddressType Index, AddressType& Address) const;
+  PagePtr failThenGetErrorPage(AddressType& Address);
+  PagePtr getErrorPage();
+  PagePtr readFillToPage(AddressType Index, AddressType& Address);
+  PagePtr writeFillToPage(AddressType Index, AddressType& Address);
 
   bool isValidPageAddress(AddressType Address) {
-    return PageIndex(Address) < PageMap.size();
+    return PageIndex(Address) <= LastPage->getPageIndex();
   }
 
   // Dumps and deletes the first page.  Note: Dumping only occurs if a
@@ -37,6 +37,10 @@ template uint32_t readVaruint32<decode::ReadCursor>(decode::ReadCursor&);
 
 template uint64_t readVaruint64<decode::ReadCursor>(decode::ReadCursor&);
 
+template void readVaruint32Array<decode::ReadCursor>(decode::ReadCursor&,
+                                                     uint32_t*,
+                                                     size_t);
+
 template uint32_t readFixed<uint32_t, decode::ReadCursor>(decode::ReadCursor&);
 
 template uint32_t readLEB128Loop<uint32_t, decode::ReadCursor>(
@@ -33,8 +33,7 @@ AddressType StringWriter::read(ByteType*, AddressType) {
 bool StringWriter::write(ByteType* Buf, AddressType Size) {
   if (IsFrozen)
     return false;
-  for (AddressType i = 0; i < Size; ++i)
-    Str.push_back(*(Buf++));
+  Str.append(reinterpret_cast<const char*>(Buf), Size);
   return true;
 }
 
@@ -46,6 +45,10 @@ bool StringWriter::atEof() {
   return IsFrozen;
 }
 
+bool StringWriter::hasErrors() {
+  return false;
+}
+
 }  // end of namespace decode
 
 }  // end of namespace wasm
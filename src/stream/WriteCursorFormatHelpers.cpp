@@ -42,6 +42,10 @@ template void writeVaruint64<decode::WriteCursor>(uint64_t,
 template void writeFixedVaruint32<decode::WriteCursor>(uint32_t,
                                                        decode::WriteCursor&);
 
+template void writeVaruint32Array<decode::WriteCursor>(const uint32_t*,
+                                                       size_t,
+                                                       decode::WriteCursor&);
+
 template void writeLEB128<uint32_t, decode::WriteCursor>(uint32_t,
                                                          decode::WriteCursor&);
 
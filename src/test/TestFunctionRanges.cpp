@@ -0,0 +1,216 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Prints the address range of each function body (including its size
+// prefix) in a WASM module, using the same format as 'decompress
+// --list-functions'. Used to check the ranges reported by the decompressor.
+//
+// If the compressed form of the WASM module is also given, it is
+// decompressed (using the C API, in small chunks) and the range and bytes
+// passed to each function callback are checked against the WASM module.
+
+#include "interp/Decompress.h"
+#include "utils/Defs.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace wasm::decode;
+
+namespace {
+
+constexpr size_t kHeaderSize = 8;
+constexpr uint32_t kCodeSectionCode = 10;
+
+bool readVaruint32(const std::vector<uint8_t>& Bytes,
+                   size_t& Address,
+                   uint32_t& Value) {
+  Value = 0;
+  for (unsigned Shift = 0; Shift < 35; Shift += 7) {
+    if (Address >= Bytes.size())
+      return false;
+    uint8_t Byte = Bytes[Address++];
+    Value |= uint32_t(Byte & 0x7f) << Shift;
+    if ((Byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+struct Range {
+  Range(size_t Begin, size_t End) : Begin(Begin), End(End) {}
+  size_t Begin;
+  size_t End;
+};
+
+bool readFile(const char* Filename, std::vector<uint8_t>& Bytes) {
+  FILE* File = fopen(Filename, "rb");
+  if (File == nullptr) {
+    fprintf(stderr, "Unable to open: %s\n", Filename);
+    return false;
+  }
+  uint8_t Buffer[4096];
+  size_t Count;
+  while ((Count = fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+    Bytes.insert(Bytes.end(), Buffer, Buffer + Count);
+  bool Okay = !ferror(File);
+  fclose(File);
+  return Okay;
+}
+
+bool findFunctions(const std::vector<uint8_t>& Bytes,
+                   std::vector<Range>& Functions) {
+  size_t Address = kHeaderSize;
+  if (Bytes.size() < Address)
+    return false;
+  while (Address < Bytes.size()) {
+    uint32_t Code;
+    uint32_t Size;
+    if (!readVaruint32(Bytes, Address, Code) ||
+        !readVaruint32(Bytes, Address, Size) ||
+        Size > Bytes.size() - Address)
+      return false;
+    size_t SectionEnd = Address + Size;
+    if (Code == kCodeSectionCode) {
+      uint32_t Count;
+      if (!readVaruint32(Bytes, Address, Count))
+        return false;
+      for (uint32_t i = 0; i < Count; ++i) {
+        size_t Begin = Address;
+        uint32_t BodySize;
+        if (!readVaruint32(Bytes, Address, BodySize) ||
+            BodySize > SectionEnd - Address)
+          return false;
+        Address += BodySize;
+        Functions.emplace_back(Begin, Address);
+      }
+    }
+    Address = SectionEnd;
+  }
+  return true;
+}
+
+// The state checked by the function callback.
+struct CallbackChecker {
+  CallbackChecker(const std::vector<uint8_t>& Bytes,
+                  const std::vector<Range>& Functions)
+      : Bytes(Bytes), Functions(Functions), NumCalls(0), ErrorsFound(false) {}
+  const std::vector<uint8_t>& Bytes;
+  const std::vector<Range>& Functions;
+  size_t NumCalls;
+  bool ErrorsFound;
+};
+
+void checkFunction(void* Data,
+                   int32_t Index,
+                   const uint8_t* Body,
+                   int32_t Begin,
+                   int32_t End) {
+  auto* Checker = static_cast<CallbackChecker*>(Data);
+  if (size_t(Index) != Checker->NumCalls++ ||
+      size_t(Index) >= Checker->Functions.size()) {
+    fprintf(stderr, "Unexpected function %" PRId32 "\n", Index);
+    Checker->ErrorsFound = true;
+    return;
+  }
+  const Range& Fcn = Checker->Functions[Index];
+  if (size_t(Begin) != Fcn.Begin || size_t(End) != Fcn.End) {
+    fprintf(stderr,
+            "Function %" PRId32 ": found [%" PRId32 ", %" PRId32
+            "), expected [%" PRIuMAX ", %" PRIuMAX ")\n",
+            Index, Begin, End, uintmax_t(Fcn.Begin), uintmax_t(Fcn.End));
+    Checker->ErrorsFound = true;
+    return;
+  }
+  if (Body == nullptr ||
+      memcmp(Body, Checker->Bytes.data() + Begin, End - Begin) != 0) {
+    fprintf(stderr, "Function %" PRId32 ": body bytes differ\n", Index);
+    Checker->ErrorsFound = true;
+  }
+}
+
+// Decompresses Compressed, checking the function callbacks against the
+// function bodies of Bytes.
+bool checkCallbacks(const std::vector<uint8_t>& Compressed,
+                    const std::vector<uint8_t>& Bytes,
+                    const std::vector<Range>& Functions) {
+  // Note: Uses small chunks so that function bodies are decompressed before
+  // the enclosing code section is available as output.
+  constexpr int32_t ChunkSize = 64;
+  CallbackChecker Checker(Bytes, Functions);
+  void* Decomp = create_decompressor();
+  set_decompressor_function_callback(Decomp, checkFunction, &Checker);
+  std::vector<uint8_t> Output;
+  uint8_t Buffer[ChunkSize];
+  size_t Address = 0;
+  int32_t Status;
+  do {
+    int32_t InSize =
+        int32_t(std::min(size_t(ChunkSize), Compressed.size() - Address));
+    int32_t Consumed;
+    int32_t Produced;
+    Status = decompress_into(Decomp, Compressed.data() + Address, InSize,
+                             Buffer, ChunkSize, &Consumed, &Produced);
+    Address += Consumed;
+    Output.insert(Output.end(), Buffer, Buffer + Produced);
+  } while (Status >= 0);
+  destroy_decompressor(Decomp);
+  if (Status != DECOMPRESSOR_SUCCESS || Output != Bytes) {
+    fprintf(stderr, "Unable to decompress\n");
+    return false;
+  }
+  if (Checker.NumCalls != Functions.size()) {
+    fprintf(stderr, "Found %" PRIuMAX " functions, expected %" PRIuMAX "\n",
+            uintmax_t(Checker.NumCalls), uintmax_t(Functions.size()));
+    return false;
+  }
+  return !Checker.ErrorsFound;
+}
+
+}  // end of anonymous namespace
+
+int main(int Argc, const char* Argv[]) {
+  if (Argc != 2 && Argc != 3) {
+    fprintf(stderr, "usage: %s FILE.wasm [COMPRESSED]\n", Argv[0]);
+    return exit_status(EXIT_FAILURE);
+  }
+  std::vector<uint8_t> Bytes;
+  if (!readFile(Argv[1], Bytes))
+    return exit_status(EXIT_FAILURE);
+  std::vector<Range> Functions;
+  if (!findFunctions(Bytes, Functions)) {
+    fprintf(stderr, "Malformed WASM module: %s\n", Argv[1]);
+    return exit_status(EXIT_FAILURE);
+  }
+  if (Argc == 3) {
+    std::vector<uint8_t> Compressed;
+    if (!readFile(Argv[2], Compressed))
+      return exit_status(EXIT_FAILURE);
+    if (!checkCallbacks(Compressed, Bytes, Functions)) {
+      fprintf(stderr, "Function callbacks failed: %s\n", Argv[2]);
+      return exit_status(EXIT_FAILURE);
+    }
+    return exit_status(EXIT_SUCCESS);
+  }
+  for (size_t i = 0; i < Functions.size(); ++i)
+    fprintf(stdout, "Function %" PRIuMAX ": [%" PRIuMAX ", %" PRIuMAX ")\n",
+            uintmax_t(i), uintmax_t(Functions[i].Begin),
+            uintmax_t(Functions[i].End));
+  return exit_status(EXIT_SUCCESS);
+}
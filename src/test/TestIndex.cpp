@@ -0,0 +1,253 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the index generated by 'compress-int --index'. Decompresses each
+// entry of the index (using decompress_indexed_entry()), and compares it
+// against the corresponding range of the original WASM module. Also checks
+// that find_decompressor_function_entry() finds each function body.
+
+#include "interp/Decompress.h"
+#include "interp/DecompressIndex.h"
+#include "utils/Defs.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+using namespace wasm::decode;
+using namespace wasm::interp;
+
+namespace {
+
+constexpr size_t kHeaderSize = 8;
+constexpr uint32_t kCodeSectionCode = 10;
+
+struct Range {
+  Range(size_t Begin, size_t End) : Begin(Begin), End(End) {}
+  size_t Begin;
+  size_t End;
+};
+
+// The ranges of the original WASM module that index entries correspond to.
+struct ModuleRanges {
+  // The range of each section (including its code and size).
+  std::vector<Range> Sections;
+  // The range of each function body (including its size prefix).
+  std::vector<Range> Functions;
+};
+
+bool readFile(const char* Filename, std::vector<uint8_t>& Bytes) {
+  FILE* File = fopen(Filename, "rb");
+  if (File == nullptr) {
+    fprintf(stderr, "Unable to open: %s\n", Filename);
+    return false;
+  }
+  uint8_t Buffer[4096];
+  size_t Count;
+  while ((Count = fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+    Bytes.insert(Bytes.end(), Buffer, Buffer + Count);
+  bool Okay = !ferror(File);
+  fclose(File);
+  return Okay;
+}
+
+bool readVaruint32(const std::vector<uint8_t>& Bytes,
+                   size_t& Address,
+                   uint32_t& Value) {
+  Value = 0;
+  for (unsigned Shift = 0; Shift < 35; Shift += 7) {
+    if (Address >= Bytes.size())
+      return false;
+    uint8_t Byte = Bytes[Address++];
+    Value |= uint32_t(Byte & 0x7f) << Shift;
+    if ((Byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+bool findRanges(const std::vector<uint8_t>& Bytes, ModuleRanges& Ranges) {
+  size_t Address = kHeaderSize;
+  if (Bytes.size() < Address)
+    return false;
+  while (Address < Bytes.size()) {
+    size_t SectionBegin = Address;
+    uint32_t Code;
+    uint32_t Size;
+    if (!readVaruint32(Bytes, Address, Code) ||
+        !readVaruint32(Bytes, Address, Size) ||
+        Size > Bytes.size() - Address)
+      return false;
+    size_t SectionEnd = Address + Size;
+    Ranges.Sections.emplace_back(SectionBegin, SectionEnd);
+    if (Code == kCodeSectionCode) {
+      uint32_t Count;
+      if (!readVaruint32(Bytes, Address, Count))
+        return false;
+      for (uint32_t i = 0; i < Count; ++i) {
+        size_t Begin = Address;
+        uint32_t BodySize;
+        if (!readVaruint32(Bytes, Address, BodySize) ||
+            BodySize > SectionEnd - Address)
+          return false;
+        Address += BodySize;
+        Ranges.Functions.emplace_back(Begin, Address);
+      }
+    }
+    Address = SectionEnd;
+  }
+  return true;
+}
+
+// Decompresses Entry of the index into Output. Returns false if unable to.
+bool decompressEntry(const std::vector<uint8_t>& Compressed,
+                     const std::vector<uint8_t>& Index,
+                     size_t Entry,
+                     std::vector<uint8_t>& Output) {
+  void* Decomp = create_decompressor();
+  constexpr int32_t MaxBufferSize = 4096;
+  uint8_t* Buffer = get_decompressor_buffer(Decomp, MaxBufferSize);
+  int32_t BufferSize = decompress_indexed_entry(
+      Decomp, Compressed.data(), int32_t(Compressed.size()), Index.data(),
+      int32_t(Index.size()), int32_t(Entry));
+  while (BufferSize > 0) {
+    int32_t ChunkSize = std::min(BufferSize, MaxBufferSize);
+    if (!fetch_decompressor_output(Decomp, ChunkSize)) {
+      BufferSize = DECOMPRESSOR_ERROR;
+      break;
+    }
+    Output.insert(Output.end(), Buffer, Buffer + ChunkSize);
+    BufferSize -= ChunkSize;
+    if (BufferSize == 0)
+      BufferSize = resume_decompression(Decomp, 0);
+  }
+  destroy_decompressor(Decomp);
+  return BufferSize == DECOMPRESSOR_SUCCESS;
+}
+
+bool checkEntry(const std::vector<uint8_t>& Compressed,
+                const std::vector<uint8_t>& Index,
+                const std::vector<uint8_t>& Original,
+                size_t Entry,
+                const Range& Expected) {
+  std::vector<uint8_t> Output;
+  if (!decompressEntry(Compressed, Index, Entry, Output)) {
+    fprintf(stderr, "Unable to decompress index entry %" PRIuMAX "\n",
+            uintmax_t(Entry));
+    return false;
+  }
+  if (Output.size() != Expected.End - Expected.Begin ||
+      !std::equal(Output.begin(), Output.end(),
+                  Original.begin() + Expected.Begin)) {
+    fprintf(stderr,
+            "Index entry %" PRIuMAX " doesn't match range [%" PRIuMAX
+            ", %" PRIuMAX ")\n",
+            uintmax_t(Entry), uintmax_t(Expected.Begin),
+            uintmax_t(Expected.End));
+    return false;
+  }
+  return true;
+}
+
+bool checkIndex(const std::vector<uint8_t>& Compressed,
+                const std::vector<uint8_t>& IndexBytes,
+                const std::vector<uint8_t>& Original) {
+  ModuleRanges Ranges;
+  if (!findRanges(Original, Ranges)) {
+    fprintf(stderr, "Malformed WASM module\n");
+    return false;
+  }
+  DecompressIndex Index;
+  if (!Index.read(IndexBytes.data(), IndexBytes.size()) ||
+      get_decompressor_index_size(IndexBytes.data(), IndexBytes.size()) !=
+          int32_t(Index.getNumEntries())) {
+    fprintf(stderr, "Malformed index\n");
+    return false;
+  }
+  bool Okay = true;
+  // Section entries appear in the same order as the sections of the module.
+  size_t NextSection = 0;
+  bool HasFunctionEntries = false;
+  for (size_t i = 0; i < Index.getNumEntries(); ++i) {
+    const DecompressIndex::Entry& Entry = Index.getEntry(i);
+    switch (Entry.Kind) {
+      case DecompressIndex::EntryKind::Section: {
+        if (NextSection >= Ranges.Sections.size()) {
+          fprintf(stderr, "Index entry %" PRIuMAX " has no matching section\n",
+                  uintmax_t(i));
+          return false;
+        }
+        if (!checkEntry(Compressed, IndexBytes, Original, i,
+                        Ranges.Sections[NextSection++]))
+          Okay = false;
+        break;
+      }
+      case DecompressIndex::EntryKind::Functions: {
+        HasFunctionEntries = true;
+        size_t Last = Entry.FirstFunction + Entry.NumFunctions;
+        if (Entry.NumFunctions == 0 || Last > Ranges.Functions.size()) {
+          fprintf(stderr,
+                  "Index entry %" PRIuMAX " has no matching functions\n",
+                  uintmax_t(i));
+          return false;
+        }
+        Range Expected(Ranges.Functions[Entry.FirstFunction].Begin,
+                       Ranges.Functions[Last - 1].End);
+        if (!checkEntry(Compressed, IndexBytes, Original, i, Expected))
+          Okay = false;
+        break;
+      }
+    }
+  }
+  if (NextSection != Ranges.Sections.size()) {
+    fprintf(stderr, "Index doesn't have an entry for each section\n");
+    Okay = false;
+  }
+  if (HasFunctionEntries) {
+    for (size_t i = 0; i < Ranges.Functions.size(); ++i) {
+      int32_t Entry = find_decompressor_function_entry(
+          IndexBytes.data(), IndexBytes.size(), int32_t(i));
+      if (Entry < 0 ||
+          Index.getEntry(Entry).Kind != DecompressIndex::EntryKind::Functions ||
+          i < Index.getEntry(Entry).FirstFunction ||
+          i >= Index.getEntry(Entry).FirstFunction +
+                   Index.getEntry(Entry).NumFunctions) {
+        fprintf(stderr, "Function %" PRIuMAX " not found in index\n",
+                uintmax_t(i));
+        Okay = false;
+      }
+    }
+  }
+  return Okay;
+}
+
+}  // end of anonymous namespace
+
+int main(int Argc, const char* Argv[]) {
+  if (Argc != 4) {
+    fprintf(stderr, "usage: %s COMPRESSED INDEX ORIGINAL.wasm\n", Argv[0]);
+    return exit_status(EXIT_FAILURE);
+  }
+  std::vector<uint8_t> Compressed;
+  std::vector<uint8_t> Index;
+  std::vector<uint8_t> Original;
+  if (!readFile(Argv[1], Compressed) || !readFile(Argv[2], Index) ||
+      !readFile(Argv[3], Original))
+    return exit_status(EXIT_FAILURE);
+  return exit_status(checkIndex(Compressed, Index, Original) ? EXIT_SUCCESS
+                                                             : EXIT_FAILURE);
+}
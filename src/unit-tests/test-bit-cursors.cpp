@@ -0,0 +1,206 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests reading and writing bit fields with BitReadCursor::readBits() and
+// BitWriteCursor::writeBits(), including fields that cross page and block
+// boundaries (where a word can't be loaded, or bytes stored, at a time).
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "stream/BitReadCursor.h"
+#include "stream/BitWriteCursor.h"
+#include "stream/Queue.h"
+#include "stream/WriteCursor.h"
+
+#include <vector>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+
+typedef BitReadCursor::WordType WordType;
+
+struct Field {
+  Field(WordType Value, unsigned Count) : Value(Value), Count(Count) {}
+  WordType Value;
+  unsigned Count;
+};
+
+// Generates (deterministic) fields of 0 to 32 bits, with random values.
+std::vector<Field> makeFields(size_t NumFields) {
+  std::vector<Field> Fields;
+  uint64_t Seed = 0x2545f4914f6cdd1d;
+  for (size_t i = 0; i < NumFields; ++i) {
+    Seed = Seed * 6364136223846793005 + 1442695040888963407;
+    unsigned Count = unsigned(Seed >> 59) + (i % 3 == 0 ? 1 : 0);
+    WordType Value = WordType(Seed >> 16);
+    if (Count < 32)
+      Value &= (WordType(1) << Count) - 1;
+    Fields.emplace_back(Value, Count);
+  }
+  // Always include the extremes.
+  Fields.emplace_back(~WordType(0), 32);
+  Fields.emplace_back(0, 0);
+  Fields.emplace_back(1, 1);
+  Fields.emplace_back(WordType(1) << 31, 32);
+  return Fields;
+}
+
+const std::vector<Field> Fields = makeFields(200);
+
+// Returns the fields as (zero padded) bytes, most significant bit first.
+std::vector<uint8_t> packFields(const std::vector<Field>& Fields) {
+  std::vector<uint8_t> Bytes;
+  unsigned NumBits = 0;
+  for (const Field& F : Fields) {
+    for (unsigned i = F.Count; i > 0; --i) {
+      if (NumBits % CHAR_BIT == 0)
+        Bytes.push_back(0);
+      uint8_t Bit = (F.Value >> (i - 1)) & 1;
+      Bytes.back() |= Bit << (CHAR_BIT - 1 - NumBits % CHAR_BIT);
+      ++NumBits;
+    }
+  }
+  return Bytes;
+}
+
+// Fills the queue with Prefix zero bytes, followed by Bytes. Note: Read
+// cursors must be created before filling, or the queue will dump pages not
+// in use.
+void fillQueue(std::shared_ptr<Queue> Que,
+               size_t Prefix,
+               const std::vector<uint8_t>& Bytes) {
+  WriteCursor WritePos(StreamType::Byte, Que);
+  for (size_t i = 0; i < Prefix; ++i)
+    WritePos.writeByte(0);
+  for (uint8_t Byte : Bytes)
+    WritePos.writeByte(Byte);
+  WritePos.freezeEof();
+}
+
+// Reads the fields, checking each value. When UseBit, single bit fields are
+// read using readBit().
+void readFields(BitReadCursor& Pos, bool UseBit, size_t Prefix) {
+  for (size_t i = 0; i < Fields.size(); ++i) {
+    const Field& F = Fields[i];
+    WordType Peeked;
+    bool CanPeek = Pos.peekBits(F.Count, Peeked);
+    WordType Value =
+        UseBit && F.Count == 1 ? Pos.readBit() : Pos.readBits(F.Count);
+    EXPECT_EQ(F.Value, Value) << "Prefix " << Prefix << ", field " << i;
+    if (CanPeek)
+      EXPECT_EQ(F.Value, Peeked)
+          << "Peeked prefix " << Prefix << ", field " << i;
+  }
+  Pos.alignToByte();
+}
+
+// Reads the fields starting at each address near the end of the first page.
+void checkReadAcrossPages(bool UseBit) {
+  std::vector<uint8_t> Bytes = packFields(Fields);
+  constexpr size_t Window = 2 * sizeof(WordType);
+  for (size_t Prefix = PageSize > Window ? PageSize - Window : 0;
+       Prefix <= PageSize + 1; ++Prefix) {
+    auto Que = std::make_shared<Queue>();
+    BitReadCursor Pos(StreamType::Byte, Que);
+    fillQueue(Que, Prefix, Bytes);
+    for (size_t i = 0; i < Prefix; ++i)
+      Pos.readByte();
+    readFields(Pos, UseBit, Prefix);
+    EXPECT_EQ(Prefix + Bytes.size(), Pos.getCurAddress())
+        << "End of prefix " << Prefix;
+    EXPECT_TRUE(Pos.atEof()) << "Prefix " << Prefix;
+  }
+}
+
+TEST(BitCursorsTest, ReadAcrossPages) {
+  checkReadAcrossPages(false);
+}
+
+TEST(BitCursorsTest, ReadBitAcrossPages) {
+  checkReadAcrossPages(true);
+}
+
+// Reads the fields of an enclosing block, followed by bytes that must not be
+// used (i.e. fields near GuaranteedBeforeEob must be read a byte at a time).
+TEST(BitCursorsTest, ReadNearEob) {
+  std::vector<uint8_t> Bytes = packFields(Fields);
+  const AddressType Eob = Bytes.size();
+  for (size_t i = 0; i < sizeof(WordType); ++i)
+    Bytes.push_back(0xff);
+  auto Que = std::make_shared<Queue>();
+  BitReadCursor Pos(StreamType::Byte, Que);
+  fillQueue(Que, 0, Bytes);
+  Pos.pushEobAddress(Eob);
+  readFields(Pos, false, 0);
+  EXPECT_EQ(Eob, Pos.getCurAddress());
+  EXPECT_TRUE(Pos.atEob());
+  WordType Value;
+  EXPECT_FALSE(Pos.peekBits(1, Value)) << "Peeked past eob";
+  Pos.popEobAddress();
+  EXPECT_EQ(~WordType(0), Pos.readBits(32)) << "After block";
+}
+
+// Writes the fields, starting at each address near the end of the first page,
+// and checks the bytes written. When UseBit, single bit fields are written
+// using writeBit(), and 8-bit fields using writeByte().
+void checkWriteAcrossPages(bool UseBit) {
+  std::vector<uint8_t> Expected = packFields(Fields);
+  constexpr size_t Window = 2 * sizeof(WordType);
+  for (size_t Prefix = PageSize > Window ? PageSize - Window : 0;
+       Prefix <= PageSize + 1; ++Prefix) {
+    auto Que = std::make_shared<Queue>();
+    ReadCursor Pos(StreamType::Byte, Que);
+    BitWriteCursor WritePos(StreamType::Byte, Que);
+    for (size_t i = 0; i < Prefix; ++i)
+      WritePos.writeByte(0);
+    for (const Field& F : Fields) {
+      if (UseBit && F.Count == 1)
+        WritePos.writeBit(ByteType(F.Value));
+      else if (UseBit && F.Count == CHAR_BIT)
+        WritePos.writeByte(ByteType(F.Value));
+      else
+        WritePos.writeBits(F.Value, F.Count);
+    }
+    WritePos.alignToByte();
+    WritePos.freezeEof();
+    EXPECT_EQ(Prefix + Expected.size(), WritePos.getCurAddress())
+        << "End of prefix " << Prefix;
+    for (size_t i = 0; i < Prefix; ++i)
+      Pos.readByte();
+    std::vector<uint8_t> Found;
+    while (!Pos.atEof())
+      Found.push_back(Pos.readByte());
+    EXPECT_EQ(Expected, Found) << "Prefix " << Prefix;
+  }
+}
+
+TEST(BitCursorsTest, WriteAcrossPages) {
+  checkWriteAcrossPages(false);
+}
+
+TEST(BitCursorsTest, WriteBitAcrossPages) {
+  checkWriteAcrossPages(true);
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
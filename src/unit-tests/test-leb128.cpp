@@ -0,0 +1,338 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests reading and writing LEB128 values, including values that cross page
+// and block boundaries (where the word-at-a-time decoder and the contiguous
+// encoder can't be used), and malformed (too long) values.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "interp/FormatHelpers-templates.h"
+#include "stream/Queue.h"
+#include "stream/ReadCursor.h"
+#include "stream/WriteCursor.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+using namespace wasm::interp;
+
+struct Encoding {
+  std::vector<uint8_t> Bytes;
+  uint64_t Value;
+  // True if Value doesn't fit the encoding of a varuint32.
+  bool Is64Bit;
+};
+
+const Encoding Encodings[] = {
+    {{0x00}, 0, false},
+    {{0x7f}, 127, false},
+    {{0x80, 0x01}, 128, false},
+    {{0xe5, 0x8e, 0x26}, 624485, false},
+    {{0x80, 0x80, 0x80, 0x01}, UINT64_C(1) << 21, false},
+    // 5-byte encodings.
+    {{0x80, 0x80, 0x80, 0x80, 0x01}, UINT64_C(1) << 28, false},
+    {{0xff, 0xff, 0xff, 0xff, 0x0f}, UINT64_C(0xffffffff), false},
+    {{0x80, 0x80, 0x80, 0x80, 0x00}, 0, false},
+    // Too long for a varuint32.
+    {{0x80, 0x80, 0x80, 0x80, 0x80, 0x00}, 0, true},
+    {{0xff, 0xff, 0xff, 0xff, 0xff, 0x01}, UINT64_C(0xfffffffff), true},
+    {{0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01}, UINT64_C(1) << 49,
+     true},
+};
+
+// Value read after each encoding, to check that the encoding was consumed.
+constexpr uint8_t Sentinel = 0x2a;
+
+// Fills the queue with Prefix zero bytes, followed by Bytes. Note: Read
+// cursors must be created before filling, or the queue will dump pages not
+// in use.
+void fillQueue(std::shared_ptr<Queue> Que,
+               size_t Prefix,
+               const std::vector<uint8_t>& Bytes) {
+  WriteCursor WritePos(StreamType::Byte, Que);
+  for (size_t i = 0; i < Prefix; ++i)
+    WritePos.writeByte(0);
+  for (uint8_t Byte : Bytes)
+    WritePos.writeByte(Byte);
+  WritePos.freezeEof();
+}
+
+// Checks that the cursor can read up to Limit, without crossing a page
+// boundary. Note: A cursor at a page boundary may not have moved to the next
+// page yet (and hence have no contiguous bytes).
+void checkContiguous(ReadCursor& Pos, AddressType Limit, const char* Where) {
+  AddressType Address = Pos.getCurAddress();
+  AddressType PageLimit = (PageIndex(Address) + 1) * PageSize;
+  size_t Expected = std::min(Limit, PageLimit) - Address;
+  size_t Found = Pos.getContiguousBytesAvailable();
+  if (Found == 0 && Address > 0 && PageAddress(Address) == 0)
+    return;
+  EXPECT_EQ(Expected, Found) << "Contiguous bytes " << Where;
+}
+
+void skipBytes(ReadCursor& Pos, size_t Count) {
+  for (size_t i = 0; i < Count; ++i)
+    Pos.readByte();
+}
+
+// Returns the bytes written to the queue, after the first Prefix bytes.
+std::vector<uint8_t> readQueue(ReadCursor& Pos, size_t Prefix) {
+  skipBytes(Pos, Prefix);
+  std::vector<uint8_t> Bytes;
+  while (!Pos.atEof())
+    Bytes.push_back(Pos.readByte());
+  return Bytes;
+}
+
+// Checks decodeLEB128Word() on a (word) buffer holding the encoding,
+// followed by bytes that must be ignored.
+TEST(LEB128Test, DecodeWord) {
+  for (const Encoding& Enc : Encodings) {
+    uint8_t Buffer[sizeof(uint64_t)];
+    for (size_t i = 0; i < sizeof(Buffer); ++i)
+      Buffer[i] = i < Enc.Bytes.size() ? Enc.Bytes[i] : 0xff;
+    uint32_t Value32 = 0;
+    uint8_t Chunk = 0;
+    uint32_t NumBytes = fmt::decodeLEB128Word(Buffer, Value32, Chunk);
+    if (Enc.Is64Bit) {
+      EXPECT_EQ(0u, NumBytes) << "Accepted as varuint32: " << Enc.Value;
+    } else {
+      EXPECT_EQ(Enc.Bytes.size(), NumBytes) << "Size of " << Enc.Value;
+      EXPECT_EQ(Enc.Value, Value32);
+      EXPECT_EQ(Enc.Bytes.back(), Chunk) << "Last chunk of " << Enc.Value;
+    }
+    uint64_t Value64 = 0;
+    NumBytes = fmt::decodeLEB128Word(Buffer, Value64, Chunk);
+    EXPECT_EQ(Enc.Bytes.size(), NumBytes) << "Size of " << Enc.Value;
+    EXPECT_EQ(Enc.Value, Value64);
+  }
+  // No terminating byte in the word.
+  uint8_t Unterminated[sizeof(uint64_t)];
+  for (size_t i = 0; i < sizeof(Unterminated); ++i)
+    Unterminated[i] = 0x80;
+  uint64_t Value64 = 0;
+  uint8_t Chunk = 0;
+  EXPECT_EQ(0u, fmt::decodeLEB128Word(Unterminated, Value64, Chunk))
+      << "Accepted unterminated value";
+}
+
+// Reads each encoding at each address near the end of the first page, so
+// that both the word-at-a-time and the byte-at-a-time paths are used.
+TEST(LEB128Test, ReadAcrossPages) {
+  for (const Encoding& Enc : Encodings) {
+    std::vector<uint8_t> Bytes(Enc.Bytes);
+    Bytes.push_back(Sentinel);
+    constexpr size_t Window = 2 * sizeof(uint64_t);
+    for (size_t Prefix = PageSize > Window ? PageSize - Window : 0;
+         Prefix <= PageSize + 1; ++Prefix) {
+      auto Que = std::make_shared<Queue>();
+      ReadCursor Pos(StreamType::Byte, Que);
+      ReadCursor Pos32(StreamType::Byte, Que);
+      fillQueue(Que, Prefix, Bytes);
+      skipBytes(Pos, Prefix);
+      EXPECT_EQ(Enc.Value, fmt::readVaruint64(Pos)) << "At " << Prefix;
+      EXPECT_EQ(Prefix + Enc.Bytes.size(), Pos.getCurAddress())
+          << "End of " << Enc.Value << " at " << Prefix;
+      EXPECT_EQ(Sentinel, fmt::readUint8(Pos)) << "At " << Prefix;
+      skipBytes(Pos32, Prefix);
+      uint32_t Value32 = fmt::readVaruint32(Pos32);
+      // Note: The value of a malformed varuint32 is undefined, but the
+      // same bytes must be consumed.
+      if (!Enc.Is64Bit)
+        EXPECT_EQ(Enc.Value, Value32) << "At " << Prefix;
+      EXPECT_EQ(Prefix + Enc.Bytes.size(), Pos32.getCurAddress())
+          << "End of varuint32 " << Enc.Value << " at " << Prefix;
+    }
+  }
+}
+
+// Reads an array of varuint32 values that crosses a page boundary.
+TEST(LEB128Test, ReadArray) {
+  std::vector<uint32_t> Values;
+  std::vector<uint8_t> Bytes;
+  size_t NumValues = 0;
+  while (Bytes.size() < 3 * PageSize) {
+    const Encoding& Enc = Encodings[NumValues++ % size(Encodings)];
+    if (Enc.Is64Bit)
+      continue;
+    Values.push_back(uint32_t(Enc.Value));
+    Bytes.insert(Bytes.end(), Enc.Bytes.begin(), Enc.Bytes.end());
+  }
+  Bytes.push_back(Sentinel);
+  for (size_t Prefix = 0; Prefix < sizeof(uint64_t); ++Prefix) {
+    auto Que = std::make_shared<Queue>();
+    ReadCursor Pos(StreamType::Byte, Que);
+    fillQueue(Que, Prefix, Bytes);
+    skipBytes(Pos, Prefix);
+    std::vector<uint32_t> Found(Values.size());
+    fmt::readVaruint32Array(Pos, Found.data(), Found.size());
+    EXPECT_EQ(Values, Found) << "Prefix " << Prefix;
+    EXPECT_EQ(Sentinel, fmt::readUint8(Pos)) << "Prefix " << Prefix;
+  }
+}
+
+// Reads values that end near the end of an enclosing block (i.e. near
+// GuaranteedBeforeEob), where fewer than a word of bytes are available.
+TEST(LEB128Test, ReadNearEob) {
+  const Encoding& Enc = Encodings[6];  // 5-byte encoding.
+  std::vector<uint8_t> Bytes;
+  for (size_t i = 0; i < 4; ++i)
+    Bytes.insert(Bytes.end(), Enc.Bytes.begin(), Enc.Bytes.end());
+  // Bytes following the block, that the word decoder must not use.
+  for (size_t i = 0; i < sizeof(uint64_t); ++i)
+    Bytes.push_back(0x80);
+  const AddressType Eob = 4 * Enc.Bytes.size();
+  auto Que = std::make_shared<Queue>();
+  ReadCursor Pos(StreamType::Byte, Que);
+  ReadCursor Pos2(StreamType::Byte, Que);
+  fillQueue(Que, 0, Bytes);
+  Pos.pushEobAddress(Eob);
+  checkContiguous(Pos, Eob, "at block start");
+  uint32_t Found[4];
+  fmt::readVaruint32Array(Pos, Found, size(Found));
+  for (size_t i = 0; i < size(Found); ++i)
+    EXPECT_EQ(Enc.Value, Found[i]) << "Value " << i;
+  EXPECT_EQ(Eob, Pos.getCurAddress());
+  EXPECT_TRUE(Pos.atEob());
+  EXPECT_EQ(0u, Pos.getContiguousBytesAvailable()) << "Contiguous at eob";
+  // Last value of the block, read one value at a time.
+  Pos2.pushEobAddress(Eob);
+  skipBytes(Pos2, Eob - Enc.Bytes.size());
+  checkContiguous(Pos2, Eob, "near eob");
+  EXPECT_EQ(Enc.Value, fmt::readVaruint32(Pos2));
+  EXPECT_EQ(Eob, Pos2.getCurAddress());
+  Pos2.popEobAddress();
+  checkContiguous(Pos2, Bytes.size(), "after block");
+}
+
+// Checks that encodeLEB128() generates each encoding, when asked for the
+// same number of bytes.
+TEST(LEB128Test, Encode) {
+  for (const Encoding& Enc : Encodings) {
+    uint8_t Buffer[16];
+    uint32_t NumBytes = uint32_t(Enc.Bytes.size());
+    fmt::encodeLEB128(Enc.Value, Buffer, NumBytes);
+    EXPECT_EQ(Enc.Bytes, std::vector<uint8_t>(Buffer, Buffer + NumBytes))
+        << "Encoding of " << Enc.Value;
+    if (Enc.Is64Bit)
+      continue;
+    fmt::encodeLEB128(uint32_t(Enc.Value), Buffer, NumBytes);
+    EXPECT_EQ(Enc.Bytes, std::vector<uint8_t>(Buffer, Buffer + NumBytes))
+        << "Encoding of uint32_t " << Enc.Value;
+  }
+}
+
+// Writes each (minimal) encoding at each address near the end of the first
+// page, so that both the contiguous and the byte-at-a-time paths are used.
+TEST(LEB128Test, WriteAcrossPages) {
+  for (const Encoding& Enc : Encodings) {
+    if (fmt::getLEB128Size(Enc.Value) != Enc.Bytes.size())
+      continue;
+    std::vector<uint8_t> Expected(Enc.Bytes);
+    Expected.push_back(Sentinel);
+    constexpr size_t Window = 2 * sizeof(uint64_t);
+    for (size_t Prefix = PageSize > Window ? PageSize - Window : 0;
+         Prefix <= PageSize + 1; ++Prefix) {
+      auto Que = std::make_shared<Queue>();
+      ReadCursor Pos(StreamType::Byte, Que);
+      WriteCursor WritePos(StreamType::Byte, Que);
+      for (size_t i = 0; i < Prefix; ++i)
+        WritePos.writeByte(0);
+      if (Enc.Is64Bit)
+        fmt::writeVaruint64(Enc.Value, WritePos);
+      else
+        fmt::writeVaruint32(uint32_t(Enc.Value), WritePos);
+      WritePos.writeByte(Sentinel);
+      WritePos.freezeEof();
+      EXPECT_EQ(Expected, readQueue(Pos, Prefix))
+          << "Writing " << Enc.Value << " at " << Prefix;
+    }
+  }
+}
+
+// Checks that writeContiguousLEB128() only writes if the value fits in the
+// current page.
+TEST(LEB128Test, WriteContiguous) {
+  // Note: Uses a 3-byte encoding, so that the value starts within the page
+  // for all page sizes.
+  const Encoding& Enc = Encodings[3];
+  auto Que = std::make_shared<Queue>();
+  ReadCursor Pos(StreamType::Byte, Que);
+  WriteCursor WritePos(StreamType::Byte, Que);
+  const size_t Prefix = PageSize - (Enc.Bytes.size() - 1);
+  for (size_t i = 0; i < Prefix; ++i)
+    WritePos.writeByte(0);
+  EXPECT_EQ(Enc.Bytes.size() - 1, WritePos.getContiguousBytesAvailable());
+  EXPECT_FALSE(fmt::writeContiguousLEB128(uint32_t(Enc.Value), WritePos,
+                                          uint32_t(Enc.Bytes.size())))
+      << "Wrote past end of page";
+  EXPECT_EQ(Prefix, WritePos.getCurAddress());
+  // A (padded) value that exactly fills the page.
+  EXPECT_TRUE(fmt::writeContiguousLEB128(uint32_t(0), WritePos,
+                                         uint32_t(Enc.Bytes.size() - 1)))
+      << "Didn't fill page";
+  EXPECT_EQ(PageSize, WritePos.getCurAddress());
+  WritePos.writeByte(Sentinel);
+  WritePos.freezeEof();
+  std::vector<uint8_t> Expected(Enc.Bytes.size() - 2, 0x80);
+  Expected.push_back(0);
+  Expected.push_back(Sentinel);
+  EXPECT_EQ(Expected, readQueue(Pos, Prefix)) << "Padded value";
+}
+
+// Writes an array of varuint32 values that crosses page boundaries, and reads
+// the values back one at a time.
+TEST(LEB128Test, WriteArray) {
+  std::vector<uint32_t> Values;
+  size_t Size = 0;
+  for (size_t i = 0; Size < 3 * PageSize; ++i) {
+    const Encoding& Enc = Encodings[i % size(Encodings)];
+    if (Enc.Is64Bit)
+      continue;
+    Values.push_back(uint32_t(Enc.Value));
+    Size += fmt::getLEB128Size(uint32_t(Enc.Value));
+  }
+  for (size_t Prefix = 0; Prefix < sizeof(uint64_t); ++Prefix) {
+    auto Que = std::make_shared<Queue>();
+    ReadCursor Pos(StreamType::Byte, Que);
+    WriteCursor WritePos(StreamType::Byte, Que);
+    for (size_t i = 0; i < Prefix; ++i)
+      WritePos.writeByte(0);
+    fmt::writeVaruint32Array(Values.data(), Values.size(), WritePos);
+    WritePos.writeByte(Sentinel);
+    WritePos.freezeEof();
+    EXPECT_EQ(Prefix + Size + 1, WritePos.getCurAddress())
+        << "Prefix " << Prefix;
+    skipBytes(Pos, Prefix);
+    for (size_t i = 0; i < Values.size(); ++i)
+      EXPECT_EQ(Values[i], fmt::readVaruint32(Pos))
+          << "Prefix " << Prefix << ", value " << i;
+    EXPECT_EQ(Sentinel, fmt::readUint8(Pos)) << "Prefix " << Prefix;
+  }
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,157 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests how a queue manages its pages. That is, the ring of pages in the
+// queue, the recycling of dumped pages, and lookups of pages that have left
+// the ring.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "stream/Queue.h"
+#include "stream/ReadCursor.h"
+#include "stream/WriteCursor.h"
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+
+// The (non-zero) byte written at each address.
+uint8_t getByte(AddressType Address) {
+  return uint8_t(Address % 251) + 1;
+}
+
+// Reads Count bytes, checking each against getByte().
+void readBytes(ReadCursor& Pos, size_t Count) {
+  for (size_t i = 0; i < Count; ++i) {
+    AddressType Address = Pos.getCurAddress();
+    EXPECT_EQ(getByte(Address), Pos.readByte()) << "At " << Address;
+  }
+}
+
+void writeBytes(WriteCursor& Pos, size_t Count) {
+  for (size_t i = 0; i < Count; ++i)
+    Pos.writeByte(getByte(Pos.getCurAddress()));
+}
+
+// Streams NumPages pages through the queue, reading each page once it has
+// been written. Dumped pages should be reused, rather than allocating new
+// pages, when MaxFreePages > 0.
+void checkRecycling(size_t MaxFreePages) {
+  constexpr size_t NumPages = 32;
+  auto Que = std::make_shared<Queue>();
+  Que->setMaxFreePages(MaxFreePages);
+  ReadCursor ReadPos(StreamType::Byte, Que);
+  WriteCursor WritePos(StreamType::Byte, Que);
+  for (size_t i = 0; i < NumPages; ++i) {
+    writeBytes(WritePos, PageSize);
+    readBytes(ReadPos, PageSize);
+  }
+  WritePos.freezeEof();
+  EXPECT_TRUE(ReadPos.atEof()) << "Not at eof";
+  EXPECT_LE(NumPages,
+            Que->getNumPagesAllocated() + Que->getNumPagesReused())
+      << "Pages created";
+  if (MaxFreePages == 0) {
+    EXPECT_EQ(0u, Que->getNumPagesReused()) << "Pages reused";
+    return;
+  }
+  // Note: At most the pages of the two cursors, and the free pages, should
+  // be allocated.
+  EXPECT_LE(Que->getNumPagesAllocated(), MaxFreePages + 2)
+      << "Pages allocated, with " << MaxFreePages << " free pages";
+}
+
+TEST(QueuePagesTest, Recycling) {
+  checkRecycling(0);
+  checkRecycling(1);
+  checkRecycling(4);
+}
+
+// Checks that recycled pages are zero filled, when writes jump past them.
+TEST(QueuePagesTest, RecycledZeroFill) {
+  auto Que = std::make_shared<Queue>();
+  ReadCursor ReadPos(StreamType::Byte, Que);
+  WriteCursor WritePos(StreamType::Byte, Que);
+  writeBytes(WritePos, 4 * PageSize);
+  readBytes(ReadPos, 4 * PageSize);
+  size_t NumReused = Que->getNumPagesReused();
+  // Jump over two pages, and part of the next.
+  AddressType Address = WritePos.getCurAddress();
+  AddressType Gap = 2 * PageSize + PageSize / 2;
+  uint8_t Byte = 0xff;
+  Address += Gap;
+  EXPECT_TRUE(Que->write(Address, &Byte, 1)) << "Unable to write";
+  EXPECT_LT(NumReused, Que->getNumPagesReused()) << "No pages reused";
+  for (AddressType i = 0; i < Gap; ++i) {
+    AddressType Address = ReadPos.getCurAddress();
+    EXPECT_EQ(0, ReadPos.readByte()) << "At " << Address;
+  }
+  EXPECT_EQ(0xff, ReadPos.readByte()) << "Written byte not found";
+}
+
+// Keeps the first page pinned while the ring grows, then releases it so that
+// the ring wraps, checking that each page is still found within the ring.
+TEST(QueuePagesTest, RingWrap) {
+  constexpr size_t NumPages = 20;
+  auto Que = std::make_shared<Queue>();
+  ReadCursor FirstPos(StreamType::Byte, Que);
+  ReadCursor ReadPos(StreamType::Byte, Que);
+  WriteCursor WritePos(StreamType::Byte, Que);
+  writeBytes(WritePos, NumPages * PageSize);
+  // Move through the ring, without dumping pages.
+  readBytes(ReadPos, NumPages * PageSize);
+  readBytes(FirstPos, PageSize / 2);
+  // Release pages in the ring, while adding more.
+  for (size_t i = 0; i < NumPages; ++i) {
+    readBytes(FirstPos, PageSize);
+    writeBytes(WritePos, PageSize);
+    readBytes(ReadPos, PageSize);
+  }
+  WritePos.freezeEof();
+  readBytes(FirstPos, NumPages * PageSize - PageSize / 2);
+  EXPECT_TRUE(FirstPos.atEof()) << "First cursor not at eof";
+  EXPECT_TRUE(ReadPos.atEof()) << "Read cursor not at eof";
+}
+
+// Looks up pages after they have left the ring. The last page must still be
+// found, while earlier pages must fail.
+TEST(QueuePagesTest, DumpedPages) {
+  auto Que = std::make_shared<Queue>();
+  {
+    WriteCursor WritePos(StreamType::Byte, Que);
+    writeBytes(WritePos, 3 * PageSize + PageSize / 2);
+    WritePos.freezeEof();
+  }
+  // The last page is still available.
+  AddressType Address = 3 * PageSize;
+  uint8_t Byte = 0;
+  EXPECT_EQ(1u, Que->read(Address, &Byte, 1)) << "Last page not found";
+  EXPECT_EQ(getByte(3 * PageSize), Byte) << "Last page";
+  EXPECT_TRUE(Que->isGood()) << "Reading last page failed queue";
+  // Earlier pages were dumped.
+  Address = PageSize;
+  EXPECT_EQ(0u, Que->read(Address, &Byte, 1)) << "Read dumped page";
+  EXPECT_FALSE(Que->isGood()) << "Reading dumped page didn't fail queue";
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
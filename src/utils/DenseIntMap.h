@@ -0,0 +1,127 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a map from integer keys to values, which uses an array (rather
+// than a hash table) for lookups when the keys are dense.
+
+#ifndef DECOMPRESSOR_SRC_UTILS_DENSEINTMAP_H
+#define DECOMPRESSOR_SRC_UTILS_DENSEINTMAP_H
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/Defs.h"
+
+namespace wasm {
+
+namespace utils {
+
+// Maps integer keys to values. Keys are collected in a hash table. On the
+// first lookup after a key is added, an array is built if the keys span a
+// small range (or at most twice the number of keys). Lookups then index the
+// array. This covers, for example, opcode and section selectors, where
+// keys are (mostly) consecutive.
+template <class KeyType, class ValueType>
+class DenseIntMap {
+  DenseIntMap() = delete;
+  DenseIntMap(const DenseIntMap&) = delete;
+  DenseIntMap& operator=(const DenseIntMap&) = delete;
+
+ public:
+  // Key ranges of at most this size are always made dense.
+  static constexpr size_t MinDenseSize = 256;
+
+  // Default is returned by get() when the key is not in the map.
+  explicit DenseIntMap(ValueType Default)
+      : Default(Default), DenseBase(0), IsDense(false), IsStale(false) {}
+  DenseIntMap(DenseIntMap&& Map) = default;
+  DenseIntMap& operator=(DenseIntMap&& Map) = default;
+
+  size_t size() const { return Map.size(); }
+
+  void setDefault(ValueType NewDefault) {
+    Default = NewDefault;
+    IsStale = true;
+  }
+
+  // Adds the key/value pair. Returns false (without changing the map) if the
+  // key is already defined.
+  bool add(KeyType Key, ValueType Value) {
+    if (!Map.emplace(Key, Value).second)
+      return false;
+    IsStale = true;
+    return true;
+  }
+
+  ValueType get(KeyType Key) const {
+    if (IsStale)
+      rebuild();
+    if (IsDense) {
+      // Note: Keys less than DenseBase wrap around to large indices.
+      size_t Index = size_t(Key - DenseBase);
+      return Index < Dense.size() ? Dense[Index] : Default;
+    }
+    auto Pos = Map.find(Key);
+    return Pos == Map.end() ? Default : Pos->second;
+  }
+
+  // Builds the array now, rather than on the next lookup. After this (and
+  // until the map is changed), get() doesn't modify the map, and hence can
+  // be called concurrently.
+  void build() const {
+    if (IsStale)
+      rebuild();
+  }
+
+ private:
+  std::unordered_map<KeyType, ValueType> Map;
+  ValueType Default;
+  mutable std::vector<ValueType> Dense;
+  mutable KeyType DenseBase;
+  mutable bool IsDense;
+  mutable bool IsStale;
+
+  void rebuild() const {
+    IsStale = false;
+    IsDense = false;
+    Dense.clear();
+    if (Map.empty())
+      return;
+    KeyType Min = Map.begin()->first;
+    KeyType Max = Min;
+    for (const auto& Pair : Map) {
+      Min = std::min(Min, Pair.first);
+      Max = std::max(Max, Pair.first);
+    }
+    // Note: Compare the difference (rather than its successor), so that the
+    // full range of KeyType doesn't overflow.
+    size_t Limit = std::max(MinDenseSize, 2 * Map.size());
+    if (uint64_t(Max - Min) >= Limit)
+      return;
+    IsDense = true;
+    DenseBase = Min;
+    Dense.assign(size_t(Max - Min) + 1, Default);
+    for (const auto& Pair : Map)
+      Dense[size_t(Pair.first - Min)] = Pair.second;
+  }
+};
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_UTILS_DENSEINTMAP_H